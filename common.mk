@@ -8,6 +8,7 @@ SRC +=	$(COMMON_DIR)/host.c \
 	$(COMMON_DIR)/action_util.c \
 	$(COMMON_DIR)/keymap.c \
 	$(COMMON_DIR)/timer.c \
+	$(COMMON_DIR)/deadline.c \
 	$(COMMON_DIR)/print.c \
 	$(COMMON_DIR)/bootloader.c \
 	$(COMMON_DIR)/suspend.c \
@@ -44,6 +45,40 @@ ifdef COMMAND_ENABLE
     OPT_DEFS += -DCOMMAND_ENABLE
 endif
 
+ifdef MATRIX_PINS_ENABLE
+    SRC += $(COMMON_DIR)/matrix_pins.c
+endif
+
+ifdef PER_KEY_DEBOUNCE_ENABLE
+    SRC += $(COMMON_DIR)/debounce.c
+    OPT_DEFS += -DPER_KEY_DEBOUNCE_ENABLE
+endif
+
+ifdef PERF_ENABLE
+    SRC += $(COMMON_DIR)/perf.c
+    OPT_DEFS += -DPERF_ENABLE
+endif
+
+ifdef COMBO_ENABLE
+    SRC += $(COMMON_DIR)/action_combo.c
+    OPT_DEFS += -DCOMBO_ENABLE
+endif
+
+ifdef LEADER_ENABLE
+    SRC += $(COMMON_DIR)/action_leader.c
+    OPT_DEFS += -DLEADER_ENABLE
+endif
+
+ifdef SPARSE_KEYMAP_ENABLE
+    SRC += $(COMMON_DIR)/keymap_sparse.c
+    OPT_DEFS += -DSPARSE_KEYMAP_ENABLE
+endif
+
+ifdef TRACE_ENABLE
+    SRC += $(COMMON_DIR)/trace.c
+    OPT_DEFS += -DTRACE_ENABLE
+endif
+
 ifdef NKRO_ENABLE
     OPT_DEFS += -DNKRO_ENABLE
 endif
@@ -64,6 +99,13 @@ ifdef BACKLIGHT_ENABLE
     OPT_DEFS += -DBACKLIGHT_ENABLE
 endif
 
+# keymaps stay in .progmem, the region holds blob
+ifdef KEYMAP_BLOB_ENABLE
+    SRC += $(COMMON_DIR)/keymap_blob.c
+    OPT_DEFS += -DKEYMAP_BLOB_ENABLE
+    EXTRALDFLAGS = -Wl,-L$(TOP_DIR),-Tldscript_keymap_avr5.x
+endif
+
 ifdef KEYMAP_SECTION_ENABLE
     OPT_DEFS += -DKEYMAP_SECTION_ENABLE
     EXTRALDFLAGS = -Wl,-L$(TOP_DIR),-Tldscript_keymap_avr5.x
@@ -24,8 +24,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "action_layer.h"
 #include "action_tapping.h"
 #include "action_macro.h"
+#include "action_combo.h"
+#include "action_leader.h"
 #include "action_util.h"
 #include "action.h"
+#include "trace.h"
 
 #ifdef DEBUG_ACTION
 #include "debug.h"
@@ -36,13 +39,34 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 void action_exec(keyevent_t event)
 {
+    // key events wait for end of macro
+    if (action_macro_playing()) {
+        action_macro_defer(event);
+        return;
+    }
+
     if (!IS_NOEVENT(event)) {
         dprint("\n---- action_exec: start -----\n");
         dprint("EVENT: "); debug_event(event); dprintln();
     }
 
-    keyrecord_t record = { .event = event };
+    // keys of leader sequence are taken by leader
+    if (action_leader_process(event)) return;
+
+    // keys of combo are held back until combo is settled
+    if (action_combo_process(event)) return;
+
+    process_event(event);
+}
 
+void process_event(keyevent_t event)
+{
+    process_record((keyrecord_t){ .event = event });
+}
+
+// record with ACTION_GEN_FIXED action keeps order with tapping key and events waiting for it
+void process_record(keyrecord_t record)
+{
 #ifndef NO_ACTION_TAPPING
     action_tapping_process(record);
 #else
@@ -55,7 +79,68 @@ void action_exec(keyevent_t event)
 
 // Action Memory: For each pressed key in the matrix, stores the action
 // that resulted from the most recent press event.
-action_t action_memory[ MATRIX_ROWS ][ MATRIX_COLS ] = {{{ 0 }}};
+//
+// Only held keys need an entry, so the memory is a small open-addressed
+// table keyed by key_t rather than a MATRIX_ROWS x MATRIX_COLS array.
+// Entries are freed on release; linear probing with backward shift keeps
+// the table free of tombstones.
+#ifndef ACTION_MEMORY_SIZE
+#define ACTION_MEMORY_SIZE 16
+#endif
+#if ACTION_MEMORY_SIZE & ( ACTION_MEMORY_SIZE - 1 )
+#error "ACTION_MEMORY_SIZE must be power of 2"
+#endif
+#define ACTION_MEMORY_EMPTY 255
+#define ACTION_MEMORY_MASK ( ACTION_MEMORY_SIZE - 1 )
+
+typedef struct {
+	key_t key;
+	action_t action;
+} action_memory_t;
+
+static action_memory_t action_memory[ ACTION_MEMORY_SIZE ] = {
+	[ 0 ... ACTION_MEMORY_SIZE - 1 ] = { .key = { .row = ACTION_MEMORY_EMPTY } }
+};
+
+// A key pressed while the table was full has no entry, its release resolves
+// through current layers. Such keys are cleared on next layer change instead.
+static bool action_memory_lost = false;
+
+static inline uint8_t action_memory_hash( key_t key ) {
+
+	return ( key.row * 5 + key.col ) & ACTION_MEMORY_MASK;
+}
+
+// Returns slot of the key, or the empty slot to store it. ACTION_MEMORY_SIZE
+// when neither is found(table full).
+static uint8_t action_memory_find( key_t key ) {
+
+	uint8_t i = action_memory_hash( key );
+	for ( uint8_t n = 0; n < ACTION_MEMORY_SIZE; n++ ) {
+		action_memory_t * slot = &action_memory[ i ];
+		if ( slot->key.row == ACTION_MEMORY_EMPTY || KEYEQ( slot->key, key ) ) {
+			return i;
+		}
+		i = ( i + 1 ) & ACTION_MEMORY_MASK;
+	}
+	return ACTION_MEMORY_SIZE;
+}
+
+static void action_memory_remove( uint8_t i ) {
+
+	// move back following entries whose probe sequence passes the hole
+	uint8_t j = i;
+	for ( uint8_t n = 1; n < ACTION_MEMORY_SIZE; n++ ) {
+		j = ( j + 1 ) & ACTION_MEMORY_MASK;
+		if ( action_memory[ j ].key.row == ACTION_MEMORY_EMPTY ) break;
+		uint8_t home = action_memory_hash( action_memory[ j ].key );
+		if ( ( ( j - home ) & ACTION_MEMORY_MASK ) >= ( ( j - i ) & ACTION_MEMORY_MASK ) ) {
+			action_memory[ i ] = action_memory[ j ];
+			i = j;
+		}
+	}
+	action_memory[ i ].key.row = ACTION_MEMORY_EMPTY;
+}
 
 // Avoid the following problem:
 //   1. Key X is pressed, sending make code for key "x".
@@ -69,15 +154,36 @@ action_t action_memory[ MATRIX_ROWS ][ MATRIX_COLS ] = {{{ 0 }}};
 //
 static void action_memory_map(keyevent_t event, action_t * action) {
 
-	action_t * slot = &action_memory[ event.key.row ][ event.key.col ];
+	uint8_t i = action_memory_find( event.key );
+	if ( i == ACTION_MEMORY_SIZE ) {
+		dprint( "action_memory: full\n" );
+		if ( event.pressed ) action_memory_lost = true;
+		return;
+	}
+	action_memory_t * slot = &action_memory[ i ];
+	bool held = ( slot->key.row != ACTION_MEMORY_EMPTY );
 
 	if ( event.pressed ) {
 
-		*slot = *action;
+		if ( action->code != ACTION_NO ) {
+			slot->key = event.key;
+			slot->action = *action;
+		} else if ( held ) {
+			action_memory_remove( i );
+		}
 
-	} else if ( slot->code != ACTION_NO ) {
+	} else if ( held ) {
 
-		*action = *slot;
+		*action = slot->action;
+		action_memory_remove( i );
+	}
+}
+
+void action_memory_clear_lost( void ) {
+
+	if ( action_memory_lost ) {
+		dprint( "action_memory: clear keys pressed while full\n" );
+		clear_keyboard_but_mods();
 	}
 }
 
@@ -90,7 +196,12 @@ void process_action(keyrecord_t *record)
 
     if (IS_NOEVENT(event)) { return; }
 
-    action_t action = layer_switch_get_action(event.key);
+#ifdef TRACE_ENABLE
+    trace_id = event.trace_id;
+    TRACE_STAMP(trace_id, TRACE_ACTION);
+#endif
+
+    action_t action = get_record_action(record);
 
 	action_memory_map( event, &action );
 
@@ -233,6 +344,14 @@ void process_action(keyrecord_t *record)
             }
             break;
 #endif
+#ifdef LEADER_ENABLE
+        /* Leader key */
+        case ACT_LEADER:
+            if (event.pressed) {
+                action_leader_start(event);
+            }
+            break;
+#endif
 #ifndef NO_ACTION_LAYER
         case ACT_LAYER:
             if (action.layer_bitop.on == 0) {
@@ -514,6 +633,7 @@ void clear_keyboard(void)
 
 void clear_keyboard_but_mods(void)
 {
+    action_memory_lost = false;
     clear_weak_mods();
     clear_keys();
     send_keyboard_report();
@@ -529,8 +649,11 @@ void clear_keyboard_but_mods(void)
 
 bool is_tap_key(key_t key)
 {
-    action_t action = layer_switch_get_action(key);
+    return is_tap_action(layer_switch_get_action(key));
+}
 
+bool is_tap_action(action_t action)
+{
     switch (action.kind.id) {
         case ACT_LMODS_TAP:
         case ACT_RMODS_TAP:
@@ -546,6 +669,16 @@ bool is_tap_key(key_t key)
 }
 
 
+action_t get_record_action(keyrecord_t *record)
+{
+    if (record->action_gen != action_generation && record->action_gen != ACTION_GEN_FIXED) {
+        record->action = layer_switch_get_action(record->event.key);
+        record->action_gen = action_generation;
+    }
+    return record->action;
+}
+
+
 /*
  * debug print
  */
@@ -571,6 +704,7 @@ void debug_action(action_t action)
         case ACT_RMODS_TAP:         dprint("ACT_RMODS_TAP");         break;
         case ACT_USAGE:             dprint("ACT_USAGE");             break;
         case ACT_MOUSEKEY:          dprint("ACT_MOUSEKEY");          break;
+        case ACT_LEADER:            dprint("ACT_LEADER");            break;
         case ACT_LAYER:             dprint("ACT_LAYER");             break;
         case ACT_LAYER_TAP:         dprint("ACT_LAYER_TAP");         break;
         case ACT_LAYER_TAP_EXT:     dprint("ACT_LAYER_TAP_EXT");     break;
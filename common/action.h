@@ -40,11 +40,19 @@ typedef struct {
 #ifndef NO_ACTION_TAPPING
     tap_t tap;
 #endif
+    action_t    action;
+    uint8_t     action_gen;     /* action_generation of action, 0: not resolved */
 } keyrecord_t;
 
+/* action_gen of record whose action is given, not resolved from keymap */
+#define ACTION_GEN_FIXED    0xFF
+
 
 /* Execute action per keyevent */
 void action_exec(keyevent_t event);
+/* key event through tapping to action, after macro and combo */
+void process_event(keyevent_t event);
+void process_record(keyrecord_t record);
 
 /* action for key */
 action_t action_for_key(uint8_t layer, key_t key);
@@ -66,6 +74,14 @@ void clear_keyboard(void);
 void clear_keyboard_but_mods(void);
 void layer_switch(uint8_t new_layer);
 bool is_tap_key(key_t key);
+bool is_tap_action(action_t action);
+
+/* clear keyboard if a key was pressed while action memory was full,
+ * its release would not undo the press after layer change */
+void action_memory_clear_lost(void);
+
+/* action of record, resolved once and again only after layer change */
+action_t get_record_action(keyrecord_t *record);
 
 /* debug */
 void debug_event(keyevent_t event);
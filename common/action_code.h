@@ -50,7 +50,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
  * ACT_MOUSEKEY(0110): TODO: Not needed?
  * 0101|xxxx| keycode     Mouse key
  *
- * 011x|xxxx xxxx xxxx    (reseved)
+ * ACT_LEADER(0110):
+ * 0110|0000 0000 0000    Leader key, starts sequence of keys
+ *
+ * 0111|xxxx xxxx xxxx    (reseved)
  *
  *
  * Layer Actions(10xx)
@@ -107,6 +110,7 @@ enum action_kind_id {
     /* Other Keys */
     ACT_USAGE           = 0b0100,
     ACT_MOUSEKEY        = 0b0101,
+    ACT_LEADER          = 0b0110,
     /* Layer Actions */
     ACT_LAYER           = 0b1000,
     ACT_LAYER_TAP       = 0b1010, /* Layer  0-15 */
@@ -226,6 +230,7 @@ enum usage_pages {
 #define ACTION_USAGE_SYSTEM(id)         ACTION(ACT_USAGE, PAGE_SYSTEM<<10 | (id))
 #define ACTION_USAGE_CONSUMER(id)       ACTION(ACT_USAGE, PAGE_CONSUMER<<10 | (id))
 #define ACTION_MOUSEKEY(key)            ACTION(ACT_MOUSEKEY, key)
+#define ACTION_LEADER()                 ACTION(ACT_LEADER, 0)
 
 
 
@@ -0,0 +1,192 @@
+/*
+ * Combo engine
+ *
+ * Each key has a mask of combos it belongs to. Presses of such keys are
+ * held back while the combos all held keys belong to remain, AND of masks.
+ * A combo is done when its size equals number of keys held back and no
+ * larger combo remains, or at COMBO_TERM. Other keys pass through at once.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/pgmspace.h>
+#include "action.h"
+#include "action_layer.h"
+#include "action_combo.h"
+#include "deadline.h"
+#include "timer.h"
+#include "util.h"
+
+#ifdef DEBUG_ACTION
+#include "debug.h"
+#else
+#include "nodebug.h"
+#endif
+
+
+#if (COMBO_MAX <= 8)
+typedef uint8_t combo_mask_t;
+#   define COMBO_FFS(bits)  bitffs(bits)
+#elif (COMBO_MAX <= 16)
+typedef uint16_t combo_mask_t;
+#   define COMBO_FFS(bits)  bitffs16(bits)
+#elif (COMBO_MAX <= 32)
+typedef uint32_t combo_mask_t;
+#   define COMBO_FFS(bits)  bitffs32(bits)
+#else
+#   error "COMBO_MAX: invalid value"
+#endif
+
+#define COMBO_BIT(c)    ((combo_mask_t)1<<(c))
+
+/* combos of each key */
+static combo_mask_t combo_masks[MATRIX_ROWS][MATRIX_COLS];
+
+/* presses held back, combos still possible with them */
+static keyevent_t combo_events[COMBO_SIZE];
+static uint8_t combo_len = 0;
+static combo_mask_t combo_candidates = 0;
+
+/* pressed combos and their keys still down */
+static combo_mask_t combo_active = 0;
+static uint8_t combo_down[COMBO_MAX];
+
+
+static combo_mask_t combo_mask(key_t key)
+{
+    if (key.row >= MATRIX_ROWS || key.col >= MATRIX_COLS) return 0;
+    return combo_masks[key.row][key.col];
+}
+
+static uint8_t combo_size(uint8_t c)
+{
+    return pgm_read_byte(&combos[c].size);
+}
+
+static key_t combo_key(uint8_t c, uint8_t i)
+{
+    return (key_t){ .col = pgm_read_byte(&combos[c].keys[i].col),
+                    .row = pgm_read_byte(&combos[c].keys[i].row) };
+}
+
+void action_combo_init(void)
+{
+    uint8_t count = (combo_count < COMBO_MAX ? combo_count : COMBO_MAX);
+    for (uint8_t c = 0; c < count; c++) {
+        for (uint8_t i = 0; i < combo_size(c); i++) {
+            key_t key = combo_key(c, i);
+            if (key.row < MATRIX_ROWS && key.col < MATRIX_COLS) {
+                combo_masks[key.row][key.col] |= COMBO_BIT(c);
+            }
+        }
+    }
+}
+
+/* press or release action of combo c, as if its first key */
+static void combo_action(uint8_t c, keyevent_t event)
+{
+    keyrecord_t record = {
+        .event = event,
+        .action = (action_t){ .code = pgm_read_word(&combos[c].action) },
+        .action_gen = ACTION_GEN_FIXED
+    };
+    record.event.key = combo_key(c, 0);
+    dprintf("combo: %u %s\n", c, (event.pressed ? "press" : "release"));
+    // through tapping, after tap key still pending
+    process_record(record);
+}
+
+/* fire combo which has exactly keys held back, or let them go */
+static void combo_settle(void)
+{
+    combo_mask_t done = 0;
+    for (combo_mask_t m = combo_candidates; m; m &= m - 1) {
+        uint8_t c = COMBO_FFS(m);
+        if (combo_size(c) == combo_len) {
+            done = COMBO_BIT(c);
+            break;
+        }
+    }
+    if (done) {
+        uint8_t c = COMBO_FFS(done);
+        combo_active |= done;
+        combo_down[c] = (1 << combo_len) - 1;
+        combo_action(c, combo_events[combo_len - 1]);
+    } else {
+        for (uint8_t i = 0; i < combo_len; i++) {
+            process_event(combo_events[i]);
+        }
+    }
+    combo_len = 0;
+    combo_candidates = 0;
+    deadline_clear(DEADLINE_COMBO);
+}
+
+/* true when no combo larger than keys held back remains */
+static bool combo_complete(void)
+{
+    for (combo_mask_t m = combo_candidates; m; m &= m - 1) {
+        if (combo_size(COMBO_FFS(m)) > combo_len) return false;
+    }
+    return true;
+}
+
+/* release of key of pressed combo */
+static bool combo_release(keyevent_t event)
+{
+    for (combo_mask_t m = combo_mask(event.key) & combo_active; m; m &= m - 1) {
+        uint8_t c = COMBO_FFS(m);
+        for (uint8_t i = 0; i < combo_size(c); i++) {
+            if (!KEYEQ(combo_key(c, i), event.key) || !(combo_down[c] & (1<<i))) continue;
+            // first key up releases combo action
+            if (combo_down[c] == (1 << combo_size(c)) - 1) {
+                combo_action(c, event);
+            }
+            combo_down[c] &= ~(1<<i);
+            if (!combo_down[c]) combo_active &= ~COMBO_BIT(c);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool action_combo_process(keyevent_t event)
+{
+    // signed as event time rounded up to odd can be ahead of timer_read()
+    if (combo_len && (IS_NOEVENT(event) ? (int16_t)(timer_read() - combo_events[0].time) :
+                                          (int16_t)(event.time - combo_events[0].time)) >= COMBO_TERM) {
+        dprint("combo: timeout\n");
+        combo_settle();
+    }
+    if (IS_NOEVENT(event)) return false;
+
+    if (!event.pressed) {
+        if (combo_release(event)) return true;
+        for (uint8_t i = 0; i < combo_len; i++) {
+            if (KEYEQ(combo_events[i].key, event.key)) {
+                // key of combo up before combo is done
+                combo_settle();
+                return combo_release(event);
+            }
+        }
+        return false;
+    }
+
+    combo_mask_t mask = combo_mask(event.key) & ~combo_active;
+    if (combo_len && !(combo_candidates & mask)) {
+        // the key breaks combo, keys held back go first in order
+        combo_settle();
+    }
+    if (!mask) return false;
+
+    if (!combo_len) {
+        combo_candidates = mask;
+        deadline_set(DEADLINE_COMBO, event.time + COMBO_TERM);
+    } else {
+        combo_candidates &= mask;
+    }
+    combo_events[combo_len++] = event;
+    if (combo_complete()) {
+        combo_settle();
+    }
+    return true;
+}
@@ -0,0 +1,66 @@
+/*
+ * Combo: set of keys pressed within COMBO_TERM runs its own action
+ *
+ * Keymap defines combos and their number:
+ *
+ *   const combo_t PROGMEM combos[] = {
+ *       COMBO(ACTION_KEY(KC_ESC), COMBO_KEY(2, 1), COMBO_KEY(2, 2)),
+ *   };
+ *   const uint8_t combo_count = sizeof(combos) / sizeof(combos[0]);
+ *
+ * Combo action is processed without tapping, release of any key of
+ * the combo releases it.
+ */
+#ifndef ACTION_COMBO_H
+#define ACTION_COMBO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/pgmspace.h>
+#include "keyboard.h"
+
+
+/* time(ms) to press all keys of combo */
+#ifndef COMBO_TERM
+#define COMBO_TERM      50
+#endif
+
+/* max number of keys of a combo */
+#ifndef COMBO_SIZE
+#define COMBO_SIZE      4
+#endif
+#if (COMBO_SIZE > 8)
+#error "COMBO_SIZE: 8 at most"
+#endif
+
+/* max number of combos: 8, 16 or 32 */
+#ifndef COMBO_MAX
+#define COMBO_MAX       8
+#endif
+
+typedef struct {
+    uint16_t action;
+    uint8_t  size;
+    key_t    keys[COMBO_SIZE];
+} combo_t;
+
+#define COMBO_KEY(r, c)     { .col = (c), .row = (r) }
+#define COMBO(act, ...)     { .action = (act), \
+                              .size = sizeof((key_t[]){ __VA_ARGS__ }) / sizeof(key_t), \
+                              .keys = { __VA_ARGS__ } }
+
+extern const combo_t combos[];
+extern const uint8_t combo_count;
+
+
+#ifdef COMBO_ENABLE
+/* compiles combos into masks of each key */
+void action_combo_init(void);
+/* returns true when event is held back or taken by combo */
+bool action_combo_process(keyevent_t event);
+#else
+#define action_combo_init()
+#define action_combo_process(event)     false
+#endif
+
+#endif
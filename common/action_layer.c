@@ -3,6 +3,8 @@
 #include "action.h"
 #include "util.h"
 #include "action_layer.h"
+#include "keymap.h"
+#include "matrix.h"
 
 #ifdef LED_CONTROLLER_ENABLE
 #include "led-local.h"
@@ -15,6 +17,31 @@
 #endif
 
 
+/* Action Generation: changes whenever result of layer_switch_get_action() may
+ * change. Action resolved with other generation is stale. Never 0 nor
+ * ACTION_GEN_FIXED.
+ */
+uint8_t action_generation = 1;
+
+#ifdef ACTION_CACHE_ENABLE
+/* Action Cache: action of each key resolved with current layer states.
+ * Cleared on change of layer states and filled on lookup.
+ */
+static action_t action_cache[MATRIX_ROWS][MATRIX_COLS];
+static matrix_row_t action_cache_valid[MATRIX_ROWS];
+#endif
+
+void action_cache_clear(void)
+{
+    if (++action_generation == ACTION_GEN_FIXED) action_generation = 1;
+#ifdef ACTION_CACHE_ENABLE
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+        action_cache_valid[i] = 0;
+    }
+#endif
+}
+
+
 /* 
  * Default Layer State
  */
@@ -26,7 +53,10 @@ static void default_layer_state_set(uint32_t state)
     default_layer_debug(); debug(" to ");
     default_layer_state = state;
     default_layer_debug(); debug("\n");
-    clear_keyboard_but_mods(); // To avoid stuck keys
+    action_cache_clear();
+    // held keys are left alone, action memory releases them with their press action;
+    // keys pressed while it was full have no entry and are cleared
+    action_memory_clear_lost();
 }
 
 void default_layer_debug(void)
@@ -67,7 +97,10 @@ static void layer_state_set(uint32_t state)
     layer_debug(); dprint(" to ");
     layer_state = state;
     layer_debug(); dprintln();
-    clear_keyboard_but_mods(); // To avoid stuck keys
+    action_cache_clear();
+    // held keys are left alone, action memory releases them with their press action;
+    // keys pressed while it was full have no entry and are cleared
+    action_memory_clear_lost();
 
 #ifdef LED_CONTROLLER_ENABLE
 	led_set_layer_indicator( state );
@@ -120,13 +153,14 @@ void layer_debug(void)
 
 
 
-action_t layer_switch_get_action(key_t key)
+static action_t layer_resolve_action(key_t key)
 {
     action_t action;
     action.code = ACTION_TRANSPARENT;
 
 #ifndef NO_ACTION_LAYER
-    uint32_t layers = layer_state | default_layer_state;
+    /* skip layers where the key is transparent */
+    uint32_t layers = (layer_state | default_layer_state) & keymap_key_layers(key);
     /* check top layer first */
     for (int8_t i = 31; i >= 0; i--) {
         if (layers & (1UL<<i)) {
@@ -144,3 +178,18 @@ action_t layer_switch_get_action(key_t key)
     return action;
 #endif
 }
+
+action_t layer_switch_get_action(key_t key)
+{
+#ifdef ACTION_CACHE_ENABLE
+    if (key.row < MATRIX_ROWS && key.col < MATRIX_COLS) {
+        matrix_row_t col_bit = (matrix_row_t)1<<key.col;
+        if (!(action_cache_valid[key.row] & col_bit)) {
+            action_cache[key.row][key.col] = layer_resolve_action(key);
+            action_cache_valid[key.row] |= col_bit;
+        }
+        return action_cache[key.row][key.col];
+    }
+#endif
+    return layer_resolve_action(key);
+}
@@ -74,4 +74,10 @@ void layer_xor(uint32_t state);
 /* return action depending on current layer status */
 action_t layer_switch_get_action(key_t key);
 
+/* generation of layer_switch_get_action() result, see get_record_action() */
+extern uint8_t action_generation;
+
+/* forget resolved actions, call when keymap result changes without layer change */
+void action_cache_clear(void);
+
 #endif
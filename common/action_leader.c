@@ -0,0 +1,135 @@
+/*
+ * Leader key engine
+ *
+ * Sequence started by ACTION_LEADER() walks trie of sequences from the root
+ * node by keycode of each key. It runs action of the node when the node has
+ * no children, or at LEADER_TIMEOUT. A key without child node ends sequence
+ * and goes on as usual, so keys are not delayed after end of sequence.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/pgmspace.h>
+#include "action.h"
+#include "action_layer.h"
+#include "action_leader.h"
+#include "deadline.h"
+#include "timer.h"
+
+#ifdef DEBUG_ACTION
+#include "debug.h"
+#else
+#include "nodebug.h"
+#endif
+
+
+#define LEADER_IDLE     0xFFFF
+
+/* current node of trie, LEADER_IDLE when no sequence */
+static uint16_t leader_node = LEADER_IDLE;
+/* last key of sequence and its time */
+static key_t leader_key;
+static uint16_t leader_time;
+
+/* keys of sequence still down, their release is taken as well */
+static key_t leader_held[LEADER_LENGTH];
+static uint8_t leader_held_len = 0;
+
+
+static uint16_t trie_word(uint16_t i)
+{
+    return pgm_read_word(&leader_trie[i]);
+}
+
+/* child of node for keycode, LEADER_IDLE when none */
+static uint16_t leader_child(uint16_t node, uint8_t code)
+{
+    uint16_t n = trie_word(node + LEADER_NODE_COUNT);
+    for (uint16_t i = node + LEADER_NODE_CHILD; n; n--, i += 2) {
+        uint16_t c = trie_word(i);
+        if (c == code) return trie_word(i + 1);
+        if (c > code) break;
+    }
+    return LEADER_IDLE;
+}
+
+/* run action of current node if any and stop sequence */
+static void leader_end(void)
+{
+    keyrecord_t record = {
+        .event = { .key = leader_key, .pressed = true, .time = leader_time },
+        .action = (action_t){ .code = trie_word(leader_node + LEADER_NODE_ACTION) },
+        .action_gen = ACTION_GEN_FIXED
+    };
+    leader_node = LEADER_IDLE;
+    deadline_clear(DEADLINE_LEADER);
+
+    if (record.action.code == ACTION_NO) {
+        dprint("leader: no sequence\n");
+        return;
+    }
+    dprintf("leader: action %04X\n", record.action.code);
+    // through tapping, after tap key still pending
+    process_record(record);
+    record.event.pressed = false;
+    process_record(record);
+}
+
+static bool leader_release(key_t key)
+{
+    for (uint8_t i = 0; i < leader_held_len; i++) {
+        if (KEYEQ(leader_held[i], key)) {
+            leader_held[i] = leader_held[--leader_held_len];
+            return true;
+        }
+    }
+    return false;
+}
+
+void action_leader_start(keyevent_t event)
+{
+    dprint("leader: start\n");
+    leader_node = 0;
+    leader_key = event.key;
+    leader_time = event.time;
+    deadline_set(DEADLINE_LEADER, event.time + LEADER_TIMEOUT);
+}
+
+bool action_leader_process(keyevent_t event)
+{
+    // signed as event time rounded up to odd can be ahead of timer_read()
+    if (leader_node != LEADER_IDLE &&
+            (IS_NOEVENT(event) ? (int16_t)(timer_read() - leader_time) :
+                                 (int16_t)(event.time - leader_time)) >= LEADER_TIMEOUT) {
+        dprint("leader: timeout\n");
+        leader_end();
+    }
+    if (IS_NOEVENT(event)) return false;
+
+    if (!event.pressed) return leader_release(event.key);
+    if (leader_node == LEADER_IDLE) return false;
+
+    // only plain keys make sequence
+    action_t action = layer_switch_get_action(event.key);
+    uint16_t child = LEADER_IDLE;
+    if (action.kind.id == ACT_LMODS && !action.key.mods) {
+        child = leader_child(leader_node, action.key.code);
+    }
+    if (child == LEADER_IDLE) {
+        // the key ends sequence and goes on as usual
+        leader_end();
+        return false;
+    }
+
+    if (leader_held_len < LEADER_LENGTH) {
+        leader_held[leader_held_len++] = event.key;
+    }
+    leader_node = child;
+    leader_key = event.key;
+    leader_time = event.time;
+    if (trie_word(child + LEADER_NODE_COUNT)) {
+        deadline_set(DEADLINE_LEADER, event.time + LEADER_TIMEOUT);
+    } else {
+        leader_end();
+    }
+    return true;
+}
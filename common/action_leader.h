@@ -0,0 +1,56 @@
+/*
+ * Leader key: ACTION_LEADER() starts a sequence of keys which runs action
+ * of the sequence. Sequences of keymap are compiled into PROGMEM trie by
+ * sim/sim_leader.c, each key of sequence walks one node of the trie.
+ */
+#ifndef ACTION_LEADER_H
+#define ACTION_LEADER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/pgmspace.h>
+#include "keyboard.h"
+
+
+/* time allowed between keys of sequence */
+#ifndef LEADER_TIMEOUT
+#define LEADER_TIMEOUT  300
+#endif
+
+/* max number of keys of sequence */
+#ifndef LEADER_LENGTH
+#define LEADER_LENGTH   4
+#endif
+
+typedef struct {
+    uint16_t action;
+    uint8_t  keys[LEADER_LENGTH];
+} leader_seq_t;
+
+/* LEADER_SEQ(ACTION_MACRO(0), KC_G, KC_M) */
+#define LEADER_SEQ(act, ...)    { .action = (act), .keys = { __VA_ARGS__ } }
+
+/* sequence table of keymap, input of sim/sim_leader.c */
+extern const leader_seq_t leader_sequences[];
+
+/* Trie of sequences, generated
+ * node: action, number of children n, then n pairs of keycode and index of child node
+ * children are sorted by keycode and root node is at index 0.
+ */
+#define LEADER_NODE_ACTION  0
+#define LEADER_NODE_COUNT   1
+#define LEADER_NODE_CHILD   2
+extern const uint16_t leader_trie[];
+
+
+#ifdef LEADER_ENABLE
+/* start sequence on press of ACTION_LEADER() */
+void action_leader_start(keyevent_t event);
+/* returns true when event is taken by sequence */
+bool action_leader_process(keyevent_t event);
+#else
+#define action_leader_start(event)
+#define action_leader_process(event)    false
+#endif
+
+#endif
@@ -14,9 +14,11 @@ GNU General Public License for more details.
 You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
-#include <util/delay.h>
 #include "action.h"
 #include "action_macro.h"
+#include "action_util.h"
+#include "timer.h"
+#include "deadline.h"
 
 #ifdef DEBUG_ACTION
 #include "debug.h"
@@ -27,15 +29,124 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #ifndef NO_ACTION_MACRO
 
+/* Macro player: plays one step each time its wait has passed, called from
+ * keyboard_task() through action_macro_task() instead of delaying inline.
+ */
+static const macro_t *macro_p = NULL;
+static uint8_t macro_interval = 0;
+static uint16_t macro_wait = 0;
+static uint16_t macro_timer = 0;
+/* key typed by KEY_TYPE or TEXT, released at next step */
+static uint8_t macro_type_code = 0;
+static uint8_t macro_type_mods = 0;
+static bool macro_text = false;
+/* modifiers held by user, out of report while TEXT types */
+static uint8_t macro_text_mods = 0;
+static const macro_t *macro_repeat_p = NULL;
+static uint8_t macro_repeat = 0;
+static uint8_t macro_mods = 0;
+
+/* US layout keycode of ASCII character, with 0x80 when shifted */
+#define SH(kc)  (0x80 | (kc))
+static const uint8_t PROGMEM ascii_to_keycode[128] = {
+    0, 0, 0, 0, 0, 0, 0, 0,
+    KC_BSPC, KC_TAB, KC_ENT, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, KC_ESC, 0, 0, 0, 0,
+    KC_SPC, SH(KC_1), SH(KC_QUOT), SH(KC_3), SH(KC_4), SH(KC_5), SH(KC_7), KC_QUOT,
+    SH(KC_9), SH(KC_0), SH(KC_8), SH(KC_EQL), KC_COMM, KC_MINS, KC_DOT, KC_SLSH,
+    KC_0, KC_1, KC_2, KC_3, KC_4, KC_5, KC_6, KC_7,
+    KC_8, KC_9, SH(KC_SCLN), KC_SCLN, SH(KC_COMM), KC_EQL, SH(KC_DOT), SH(KC_SLSH),
+    SH(KC_2), SH(KC_A), SH(KC_B), SH(KC_C), SH(KC_D), SH(KC_E), SH(KC_F), SH(KC_G),
+    SH(KC_H), SH(KC_I), SH(KC_J), SH(KC_K), SH(KC_L), SH(KC_M), SH(KC_N), SH(KC_O),
+    SH(KC_P), SH(KC_Q), SH(KC_R), SH(KC_S), SH(KC_T), SH(KC_U), SH(KC_V), SH(KC_W),
+    SH(KC_X), SH(KC_Y), SH(KC_Z), KC_LBRC, KC_BSLS, KC_RBRC, SH(KC_6), SH(KC_MINS),
+    KC_GRV, KC_A, KC_B, KC_C, KC_D, KC_E, KC_F, KC_G,
+    KC_H, KC_I, KC_J, KC_K, KC_L, KC_M, KC_N, KC_O,
+    KC_P, KC_Q, KC_R, KC_S, KC_T, KC_U, KC_V, KC_W,
+    KC_X, KC_Y, KC_Z, SH(KC_LBRC), SH(KC_BSLS), SH(KC_RBRC), SH(KC_GRV), KC_DEL,
+};
+#undef SH
+
+/* macros started while playing another, oldest first */
+static const macro_t *macro_queue[MACRO_QUEUE_SIZE];
+static uint8_t macro_queue_head = 0;
+static uint8_t macro_queue_tail = 0;
+
+/* key events waiting for end of macro */
+static keyevent_t macro_events[MACRO_EVENT_QUEUE_SIZE];
+static uint8_t macro_events_head = 0;
+static uint8_t macro_events_tail = 0;
+
 #define MACRO_READ()  (macro = pgm_read_byte(macro_p++))
-void action_macro_play(const macro_t *macro_p)
+
+/* skip commands of REPEAT(0) till REPEAT_END */
+static void macro_skip_repeat(void)
 {
-    macro_t macro = END;
-    uint8_t interval = 0;
+    macro_t macro;
 
-    if (!macro_p) return;
     while (true) {
         switch (MACRO_READ()) {
+            case KEY_DOWN:
+            case KEY_UP:
+            case WAIT:
+            case INTERVAL:
+            case KEY_TYPE:
+            case MODS_BEGIN:
+                macro_p++;
+                break;
+            case TEXT:
+                while (MACRO_READ()) ;
+                break;
+            case REPEAT_END:
+                return;
+            case END:
+                // played as end of macro
+                macro_p--;
+                return;
+        }
+    }
+}
+
+static void macro_run(void)
+{
+    macro_t macro = END;
+
+    while (macro_p) {
+        // elapsed time more than wait to wait whole milli-seconds at least
+        if (macro_wait && timer_elapsed(macro_timer) <= macro_wait) return;
+        macro_wait = 0;
+        if (macro_type_code) {
+            dprintf("TYPE UP(%02X)\n", macro_type_code);
+            unregister_code(macro_type_code);
+            if (macro_type_mods) {
+                del_weak_mods(macro_type_mods);
+                send_keyboard_report();
+            }
+            macro_type_code = 0;
+            macro_type_mods = 0;
+        } else if (macro_text) {
+            uint8_t c = MACRO_READ();
+            if (!c) {
+                macro_text = false;
+                if (macro_text_mods) {
+                    add_mods(macro_text_mods);
+                    send_keyboard_report();
+                    macro_text_mods = 0;
+                }
+                continue;
+            }
+            uint8_t code = (c < 0x80 ? pgm_read_byte(&ascii_to_keycode[c]) : 0);
+            dprintf("TEXT(%02X:%02X)\n", c, code);
+            macro_type_code = code & 0x7F;
+            if (macro_type_code) {
+                if (code & 0x80) {
+                    macro_type_mods = MOD_BIT(KC_LSHIFT);
+                    add_weak_mods(macro_type_mods);
+                }
+                register_code(macro_type_code);
+            }
+        } else switch (MACRO_READ()) {
             case KEY_DOWN:
                 MACRO_READ();
                 dprintf("KEY_DOWN(%02X)\n", macro);
@@ -49,11 +160,51 @@ void action_macro_play(const macro_t *macro_p)
             case WAIT:
                 MACRO_READ();
                 dprintf("WAIT(%u)\n", macro);
-                { uint8_t ms = macro; while (ms--) _delay_ms(1); }
+                macro_wait = macro;
                 break;
             case INTERVAL:
-                interval = MACRO_READ();
-                dprintf("INTERVAL(%u)\n", interval);
+                macro_interval = MACRO_READ();
+                dprintf("INTERVAL(%u)\n", macro_interval);
+                break;
+            case KEY_TYPE:
+                MACRO_READ();
+                dprintf("KEY_TYPE(%02X)\n", macro);
+                register_code(macro);
+                macro_type_code = macro;
+                break;
+            case TEXT:
+                dprint("TEXT\n");
+                macro_text = true;
+                // characters are typed as is, regardless of held modifiers
+                macro_text_mods = get_mods();
+                del_mods(macro_text_mods);
+                continue;
+            case REPEAT:
+                macro_repeat = MACRO_READ();
+                macro_repeat_p = macro_p;
+                dprintf("REPEAT(%u)\n", macro_repeat);
+                if (!macro_repeat) macro_skip_repeat();
+                continue;
+            case REPEAT_END:
+                dprint("REPEAT_END\n");
+                if (macro_repeat > 1) {
+                    macro_repeat--;
+                    macro_p = macro_repeat_p;
+                }
+                continue;
+            case MODS_BEGIN:
+                MACRO_READ();
+                dprintf("MODS_BEGIN(%02X)\n", macro);
+                // weak mods leave modifiers held by user as they are
+                macro_mods |= macro;
+                add_weak_mods(macro);
+                send_keyboard_report();
+                break;
+            case MODS_END:
+                dprintf("MODS_END(%02X)\n", macro_mods);
+                del_weak_mods(macro_mods);
+                send_keyboard_report();
+                macro_mods = 0;
                 break;
             case 0x04 ... 0x73:
                 dprintf("DOWN(%02X)\n", macro);
@@ -65,10 +216,97 @@ void action_macro_play(const macro_t *macro_p)
                 break;
             case END:
             default:
+                if (macro_mods) {
+                    del_weak_mods(macro_mods);
+                    send_keyboard_report();
+                    macro_mods = 0;
+                }
+                macro_p = NULL;
                 return;
         }
         // interval
-        { uint8_t ms = interval; while (ms--) _delay_ms(1); }
+        macro_wait += macro_interval;
+        macro_timer = timer_read();
     }
 }
+
+/* wakeup for next step, macro_run() returns while waiting or at end */
+static void macro_schedule(void)
+{
+    if (macro_p) {
+        deadline_set(DEADLINE_MACRO, macro_timer + macro_wait + 1);
+    } else {
+        deadline_clear(DEADLINE_MACRO);
+    }
+}
+
+static void macro_start(const macro_t *macro)
+{
+    macro_p = macro;
+    macro_interval = 0;
+    macro_wait = 0;
+    macro_text = false;
+    macro_repeat = 0;
+    macro_run();
+}
+
+/* start macros queued till one of them waits */
+static void macro_next(void)
+{
+    while (!macro_p && macro_queue_tail != macro_queue_head) {
+        const macro_t *macro = macro_queue[macro_queue_tail];
+        macro_queue_tail = (macro_queue_tail + 1) % MACRO_QUEUE_SIZE;
+        macro_start(macro);
+    }
+}
+
+void action_macro_play(const macro_t *macro)
+{
+    if (!macro) return;
+    // one macro at a time: queue it till one started before ends
+    if (macro_p) {
+        uint8_t next = (macro_queue_head + 1) % MACRO_QUEUE_SIZE;
+        if (next == macro_queue_tail) {
+            dprint("macro: queue full\n");
+            return;
+        }
+        macro_queue[macro_queue_head] = macro;
+        macro_queue_head = next;
+        return;
+    }
+    macro_start(macro);
+    macro_schedule();
+}
+
+void action_macro_task(void)
+{
+    macro_run();
+    macro_next();
+    // then key events in order, which may start another macro
+    while (!macro_p && macro_events_tail != macro_events_head) {
+        keyevent_t event = macro_events[macro_events_tail];
+        macro_events_tail = (macro_events_tail + 1) % MACRO_EVENT_QUEUE_SIZE;
+        action_exec(event);
+        macro_next();
+    }
+    macro_schedule();
+}
+
+bool action_macro_playing(void)
+{
+    return macro_p;
+}
+
+bool action_macro_busy(void)
+{
+    return (macro_events_head + 1) % MACRO_EVENT_QUEUE_SIZE == macro_events_tail;
+}
+
+void action_macro_defer(keyevent_t event)
+{
+    if (IS_NOEVENT(event) || action_macro_busy()) return;
+    dprint("macro: defer event\n");
+    macro_events[macro_events_head] = event;
+    macro_events_head = (macro_events_head + 1) % MACRO_EVENT_QUEUE_SIZE;
+}
 #endif
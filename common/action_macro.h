@@ -17,7 +17,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef ACTION_MACRO_H
 #define ACTION_MACRO_H
 #include <stdint.h>
+#include <stdbool.h>
 #include <avr/pgmspace.h>
+#include "keyboard.h"
 
 
 #define MACRO_NONE  0
@@ -27,10 +29,34 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 typedef uint8_t macro_t;
 
 
+/* key events deferred while playing macro */
+#ifndef MACRO_EVENT_QUEUE_SIZE
+#define MACRO_EVENT_QUEUE_SIZE  8
+#endif
+
+/* macros started while playing another, they play in order */
+#ifndef MACRO_QUEUE_SIZE
+#define MACRO_QUEUE_SIZE        4
+#endif
+
 #ifndef NO_ACTION_MACRO
+/* start playing macro, steps without wait are played right away
+ * Macro started while playing another waits in queue for its end.
+ */
 void action_macro_play(const macro_t *macro_p);
+/* play steps whose wait has passed and key events deferred, call this repeatedly */
+void action_macro_task(void);
+bool action_macro_playing(void);
+/* true when no room to defer key event */
+bool action_macro_busy(void);
+/* defer key event till end of macro */
+void action_macro_defer(keyevent_t event);
 #else
 #define action_macro_play(macro)
+#define action_macro_task()
+#define action_macro_playing()  false
+#define action_macro_busy()     false
+#define action_macro_defer(event)
 #endif
 
 
@@ -43,15 +69,22 @@ void action_macro_play(const macro_t *macro_p);
  *   WAIT                               // wait milli-seconds
  *   INTERVAL                           // set interval between macro commands
  *   END                                // stop macro execution
+ *   { KEY_TYPE, code(0x04-0xff) }      // 0x76: key down and up(2bytes), released at next command
+ *   { TEXT, ascii, ..., 0 }            // 0x77: type ASCII characters of US layout with shift as needed
+ *                                      //       (1byte each), modifiers held by user are out meanwhile
+ *   { REPEAT, count }                  // 0x78: play commands till REPEAT_END count times(2bytes),
+ *                                      //       0 skips them, not nestable
+ *   REPEAT_END                         // 0x79: end of commands of REPEAT(1byte)
+ *   { MODS_BEGIN, mod bits }           // 0x7A: hold modifiers over commands till MODS_END(2bytes),
+ *                                      //       along with modifiers held by user
+ *   MODS_END                           // 0x7B: release modifiers of MODS_BEGIN(1byte), also at END
  *
  * Ideas(Not implemented):
- *   modifiers
  *   system usage
  *   consumer usage
  *   unicode usage
  *   function call
  *   conditionals
- *   loop
  */
 enum macro_command_id{
     /* 0x00 - 0x03 */
@@ -64,6 +97,12 @@ enum macro_command_id{
     /* 0x74 - 0x83 */
     WAIT                = 0x74,
     INTERVAL,
+    KEY_TYPE,
+    TEXT,
+    REPEAT,
+    REPEAT_END,
+    MODS_BEGIN,
+    MODS_END,
 
     /* 0x84 - 0xf3 (reserved for keycode up) */
 
@@ -79,9 +118,14 @@ enum macro_command_id{
 */
 #define DOWN(key)       KEY_DOWN, (key)
 #define UP(key)         KEY_UP, (key)
-#define TYPE(key)       DOWN(key), UP(key)
+#define TYPE(key)       KEY_TYPE, (key)
 #define WAIT(ms)        WAIT, (ms)
 #define INTERVAL(ms)    INTERVAL, (ms)
+/* TEXT('H', 'i', '!') */
+#define TEXT(...)       TEXT, __VA_ARGS__, 0
+#define REPEAT(count)   REPEAT, (count)
+/* MODS(MOD_BIT(KC_LCTRL)), T(C), MODS_END */
+#define MODS(mods)      MODS_BEGIN, (mods)
 
 /* key down */
 #define D(key)          DOWN(KC_##key)
@@ -5,6 +5,7 @@
 #include "action_tapping.h"
 #include "keycode.h"
 #include "timer.h"
+#include "deadline.h"
 
 #ifdef DEBUG_ACTION
 #include "debug.h"
@@ -25,10 +26,13 @@ static keyrecord_t tapping_key = {};
 static keyrecord_t waiting_buffer[WAITING_BUFFER_SIZE] = {};
 static uint8_t waiting_buffer_head = 0;
 static uint8_t waiting_buffer_tail = 0;
+uint8_t waiting_buffer_high = 0;
+uint16_t waiting_buffer_forced = 0;
 
 static bool process_tapping(keyrecord_t *record);
 static bool waiting_buffer_enq(keyrecord_t record);
-static void waiting_buffer_clear(void);
+static void waiting_buffer_process(void);
+static void waiting_buffer_settle(void);
 static bool waiting_buffer_typed(keyevent_t event);
 static bool waiting_buffer_has_anykey_pressed(void);
 static void waiting_buffer_scan_tap(void);
@@ -43,12 +47,9 @@ void action_tapping_process(keyrecord_t record)
             debug("processed: "); debug_record(record); debug("\n");
         }
     } else {
-        if (!waiting_buffer_enq(record)) {
-            // clear all in case of overflow.
-            debug("OVERFLOW: CLEAR ALL STATES\n");
-            clear_keyboard();
-            waiting_buffer_clear();
-            tapping_key = (keyrecord_t){};
+        // make room instead of losing events, each settle frees a slot at least
+        while (!waiting_buffer_enq(record)) {
+            waiting_buffer_settle();
         }
     }
 
@@ -56,17 +57,18 @@ void action_tapping_process(keyrecord_t record)
     if (!IS_NOEVENT(record.event) && waiting_buffer_head != waiting_buffer_tail) {
         debug("---- action_exec: process waiting_buffer -----\n");
     }
-    for (; waiting_buffer_tail != waiting_buffer_head; waiting_buffer_tail = (waiting_buffer_tail + 1) % WAITING_BUFFER_SIZE) {
-        if (process_tapping(&waiting_buffer[waiting_buffer_tail])) {
-            debug("processed: waiting_buffer["); debug_dec(waiting_buffer_tail); debug("] = ");
-            debug_record(waiting_buffer[waiting_buffer_tail]); debug("\n\n");
-        } else {
-            break;
-        }
-    }
+    waiting_buffer_process();
     if (!IS_NOEVENT(record.event)) {
         debug("\n");
     }
+
+    // TICK changes nothing until tapping key is out of TAPPING_TERM,
+    // 1ms earlier as time of TICK may be rounded up to odd.
+    if (IS_TAPPING()) {
+        deadline_set(DEADLINE_TAPPING, tapping_key.event.time + TAPPING_TERM - 1);
+    } else {
+        deadline_clear(DEADLINE_TAPPING);
+    }
 }
 
 
@@ -96,12 +98,13 @@ bool process_tapping(keyrecord_t *keyp)
                     // enqueue
                     return false;
                 }
-#if TAPPING_TERM >= 500
                 /* Process a key typed within TAPPING_TERM
                  * This can register the key before settlement of tapping,
                  * useful for long TAPPING_TERM but may prevent fast typing.
+                 * Permissive hold does this with any TAPPING_TERM.
                  */
-                else if (IS_RELEASED(event) && waiting_buffer_typed(event)) {
+                else if (IS_RELEASED(event) && waiting_buffer_typed(event) &&
+                        (TAPPING_TERM >= 500 || tapping_permissive_hold(&tapping_key))) {
                     debug("Tapping: End. No tap. Interfered by typing key\n");
                     process_action(&tapping_key);
                     tapping_key = (keyrecord_t){};
@@ -109,14 +112,13 @@ bool process_tapping(keyrecord_t *keyp)
                     // enqueue
                     return false;
                 }
-#endif
                 /* Process release event of a key pressed before tapping starts
                  * Without this unexpected repeating will occur with having fast repeating setting
                  * https://github.com/tmk/tmk_keyboard/issues/60
                  */
                 else if (IS_RELEASED(event) && !waiting_buffer_typed(event)) {
                     // Modifier should be retained till end of this tapping.
-                    action_t action = layer_switch_get_action(event.key);
+                    action_t action = get_record_action(keyp);
                     switch (action.kind.id) {
                         case ACT_LMODS:
                         case ACT_RMODS:
@@ -153,7 +155,7 @@ bool process_tapping(keyrecord_t *keyp)
                     debug_tapping_key();
                     return true;
                 }
-                else if (is_tap_key(event.key) && event.pressed) {
+                else if (is_tap_action(get_record_action(keyp)) && event.pressed) {
                     if (tapping_key.tap.count > 1) {
                         debug("Tapping: Start new tap with releasing last tap(>1).\n");
                         // unregister key
@@ -161,7 +163,9 @@ bool process_tapping(keyrecord_t *keyp)
                                 .tap = tapping_key.tap,
                                 .event.key = tapping_key.event.key,
                                 .event.time = event.time,
-                                .event.pressed = false
+                                .event.pressed = false,
+                                .action = tapping_key.action,
+                                .action_gen = tapping_key.action_gen
                         });
                     } else {
                         debug("Tapping: Start while last tap(1).\n");
@@ -197,7 +201,7 @@ bool process_tapping(keyrecord_t *keyp)
                     tapping_key = (keyrecord_t){};
                     return true;
                 }
-                else if (is_tap_key(event.key) && event.pressed) {
+                else if (is_tap_action(get_record_action(keyp)) && event.pressed) {
                     if (tapping_key.tap.count > 1) {
                         debug("Tapping: Start new tap with releasing last timeout tap(>1).\n");
                         // unregister key
@@ -205,7 +209,9 @@ bool process_tapping(keyrecord_t *keyp)
                                 .tap = tapping_key.tap,
                                 .event.key = tapping_key.event.key,
                                 .event.time = event.time,
-                                .event.pressed = false
+                                .event.pressed = false,
+                                .action = tapping_key.action,
+                                .action_gen = tapping_key.action_gen
                         });
                     } else {
                         debug("Tapping: Start while last timeout tap(1).\n");
@@ -242,7 +248,7 @@ bool process_tapping(keyrecord_t *keyp)
                         tapping_key = *keyp;
                         return true;
                     }
-                } else if (is_tap_key(event.key)) {
+                } else if (is_tap_action(get_record_action(keyp))) {
                     // Sequential tap can be interfered with other tap key.
                     debug("Tapping: Start with interfering other tap.\n");
                     tapping_key = *keyp;
@@ -273,7 +279,7 @@ bool process_tapping(keyrecord_t *keyp)
     }
     // not tapping state
     else {
-        if (event.pressed && is_tap_key(event.key)) {
+        if (event.pressed && is_tap_action(get_record_action(keyp))) {
             debug("Tapping: Start(Press tap key).\n");
             tapping_key = *keyp;
             waiting_buffer_scan_tap();
@@ -287,6 +293,18 @@ bool process_tapping(keyrecord_t *keyp)
 }
 
 
+/* Permissive hold: settle tap key as hold when other key is typed while it is held */
+__attribute__ ((weak))
+bool tapping_permissive_hold(keyrecord_t *record)
+{
+#ifdef PERMISSIVE_HOLD
+    return true;
+#else
+    return false;
+#endif
+}
+
+
 /*
  * Waiting buffer
  */
@@ -304,14 +322,43 @@ bool waiting_buffer_enq(keyrecord_t record)
     waiting_buffer[waiting_buffer_head] = record;
     waiting_buffer_head = (waiting_buffer_head + 1) % WAITING_BUFFER_SIZE;
 
+    uint8_t len = (waiting_buffer_head + WAITING_BUFFER_SIZE - waiting_buffer_tail) % WAITING_BUFFER_SIZE;
+    if (len > waiting_buffer_high) waiting_buffer_high = len;
+
     debug("waiting_buffer_enq: "); debug_waiting_buffer();
     return true;
 }
 
-void waiting_buffer_clear(void)
+void waiting_buffer_process(void)
+{
+    for (; waiting_buffer_tail != waiting_buffer_head; waiting_buffer_tail = (waiting_buffer_tail + 1) % WAITING_BUFFER_SIZE) {
+        if (process_tapping(&waiting_buffer[waiting_buffer_tail])) {
+            debug("processed: waiting_buffer["); debug_dec(waiting_buffer_tail); debug("] = ");
+            debug_record(waiting_buffer[waiting_buffer_tail]); debug("\n\n");
+        } else {
+            break;
+        }
+    }
+}
+
+/* Settle tapping key as hold and process events waiting for it.
+ * Tap in progress is kept as its tap code is registered already, events
+ * behind it are processed anyway. At least the oldest event is processed.
+ */
+void waiting_buffer_settle(void)
 {
-    waiting_buffer_head = 0;
-    waiting_buffer_tail = 0;
+    if (IS_TAPPING_PRESSED()) {
+        if (tapping_key.tap.count == 0) {
+            debug("Tapping: End. Forced hold by full waiting buffer\n");
+            process_action(&tapping_key);
+            waiting_buffer_forced++;
+            tapping_key = (keyrecord_t){};
+        }
+    } else {
+        tapping_key = (keyrecord_t){};
+    }
+    debug_tapping_key();
+    waiting_buffer_process();
 }
 
 bool waiting_buffer_typed(keyevent_t event)
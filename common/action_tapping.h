@@ -29,11 +29,25 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define TAPPING_TOGGLE  5
 #endif
 
-#define WAITING_BUFFER_SIZE 8
+/* events held while tapping is not settled.
+ * tap key is settled as hold forcibly when this gets full.
+ */
+#ifndef WAITING_BUFFER_SIZE
+#define WAITING_BUFFER_SIZE 16
+#endif
 
 
 #ifndef NO_ACTION_TAPPING
 void action_tapping_process(keyrecord_t record);
+
+/* waiting buffer statistics: most events held and forced settlements */
+extern uint8_t waiting_buffer_high;
+extern uint16_t waiting_buffer_forced;
+
+/* settle tap key of the record as hold when other key is typed while it is held.
+ * true with PERMISSIVE_HOLD, override to choose per key or action.
+ */
+bool tapping_permissive_hold(keyrecord_t *record);
 #endif
 
 #endif
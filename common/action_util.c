@@ -19,6 +19,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "debug.h"
 #include "action_util.h"
 #include "timer.h"
+#include "deadline.h"
+#include "trace.h"
+#include "util.h"
 
 static inline void add_key_byte(uint8_t code);
 static inline void del_key_byte(uint8_t code);
@@ -35,6 +38,37 @@ static uint8_t weak_mods = 0;
 //report_keyboard_t keyboard_report = {};
 report_keyboard_t *keyboard_report = &(report_keyboard_t){};
 
+/* keys in report, counted on change */
+static uint8_t key_count = 0;
+
+/* 6KRO report: keycodes in report and its free slots
+ * Only slots host sees are used, NKRO build sends 6KRO report in short form.
+ */
+static uint8_t key_bits[32];
+#if (KEYBOARD_REPORT_KEYS <= 8)
+typedef uint8_t key_slots_t;
+#   define KEY_SLOTS_FFS(bits)  bitffs(bits)
+#elif (KEYBOARD_REPORT_KEYS <= 16)
+typedef uint16_t key_slots_t;
+#   define KEY_SLOTS_FFS(bits)  bitffs16(bits)
+#else
+typedef uint32_t key_slots_t;
+#   define KEY_SLOTS_FFS(bits)  bitffs32(bits)
+#endif
+#define KEY_SLOTS_ALL   ((key_slots_t)~0 >> (sizeof(key_slots_t)*8 - KEYBOARD_REPORT_KEYS))
+static key_slots_t key_slots_free = KEY_SLOTS_ALL;
+
+/* keys pressed while 6KRO report is full, oldest first.
+ * They go into report as slots free up.
+ */
+#ifndef KEY_OVERFLOW_SIZE
+#   define KEY_OVERFLOW_SIZE    8
+#endif
+static uint8_t key_overflow[KEY_OVERFLOW_SIZE];
+static uint8_t key_overflow_len = 0;
+
+#define KEY_BIT_IS_ON(code) (key_bits[(code)>>3] & (1<<((code)&7)))
+
 #ifndef NO_ACTION_ONESHOT
 static int8_t oneshot_mods = 0;
 #if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
@@ -60,6 +94,7 @@ void send_keyboard_report(void) {
         }
     }
 #endif
+    TRACE_STAMP(trace_id, TRACE_REPORT);
     host_keyboard_send(keyboard_report);
 }
 
@@ -92,7 +127,50 @@ void clear_keys(void)
     for (int8_t i = 1; i < REPORT_SIZE; i++) {
         keyboard_report->raw[i] = 0;
     }
+    for (uint8_t i = 0; i < sizeof(key_bits); i++) {
+        key_bits[i] = 0;
+    }
+    key_count = 0;
+    key_slots_free = KEY_SLOTS_ALL;
+    key_overflow_len = 0;
+}
+
+#ifdef NKRO_ENABLE
+/* switch report mode, keys held move to report of the mode
+ * Report of the old mode is released as it goes to its own endpoint.
+ */
+void set_keyboard_nkro(bool nkro)
+{
+    if (nkro == keyboard_nkro) return;
+
+    uint8_t held[REPORT_BITS];
+    for (uint8_t i = 0; i < REPORT_BITS; i++) held[i] = 0;
+    if (keyboard_nkro) {
+        for (uint8_t i = 0; i < REPORT_BITS; i++) held[i] = keyboard_report->nkro.bits[i];
+    } else {
+        for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+            uint8_t code = keyboard_report->keys[i];
+            if (code && (code>>3) < REPORT_BITS) held[code>>3] |= 1<<(code&7);
+        }
+    }
+    // oldest of overflow first to take 6KRO slots
+    uint8_t overflow[KEY_OVERFLOW_SIZE];
+    uint8_t overflow_len = key_overflow_len;
+    for (uint8_t i = 0; i < overflow_len; i++) overflow[i] = key_overflow[i];
+
+    clear_keys();
+    send_keyboard_report();
+    keyboard_nkro = nkro;
+
+    for (uint8_t i = 0; i < REPORT_BITS; i++) {
+        for (uint8_t j = 0; j < 8; j++) {
+            if (held[i] & 1<<j) add_key(i<<3 | j);
+        }
+    }
+    for (uint8_t i = 0; i < overflow_len; i++) add_key(overflow[i]);
+    send_keyboard_report();
 }
+#endif
 
 
 /* modifier */
@@ -116,6 +194,7 @@ void set_oneshot_mods(uint8_t mods)
     oneshot_mods = mods;
 #if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
     oneshot_time = timer_read();
+    deadline_set(DEADLINE_ONESHOT, oneshot_time + ONESHOT_TIMEOUT);
 #endif
 }
 void clear_oneshot_mods(void)
@@ -123,6 +202,7 @@ void clear_oneshot_mods(void)
     oneshot_mods = 0;
 #if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
     oneshot_time = 0;
+    deadline_clear(DEADLINE_ONESHOT);
 #endif
 }
 #endif
@@ -135,12 +215,7 @@ void clear_oneshot_mods(void)
  */
 uint8_t has_anykey(void)
 {
-    uint8_t cnt = 0;
-    for (uint8_t i = 1; i < REPORT_SIZE; i++) {
-        if (keyboard_report->raw[i])
-            cnt++;
-    }
-    return cnt;
+    return key_count;
 }
 
 uint8_t has_anymod(void)
@@ -164,31 +239,65 @@ uint8_t get_first_key(void)
 
 
 /* local functions */
-static inline void add_key_byte(uint8_t code)
+static void key_overflow_add(uint8_t code)
 {
-    int8_t i = 0;
-    int8_t empty = -1;
-    for (; i < REPORT_KEYS; i++) {
-        if (keyboard_report->keys[i] == code) {
-            break;
-        }
-        if (empty == -1 && keyboard_report->keys[i] == 0) {
-            empty = i;
-        }
+    for (uint8_t i = 0; i < key_overflow_len; i++) {
+        if (key_overflow[i] == code) return;
     }
-    if (i == REPORT_KEYS) {
-        if (empty != -1) {
-            keyboard_report->keys[empty] = code;
-        }
+    if (key_overflow_len < KEY_OVERFLOW_SIZE) {
+        key_overflow[key_overflow_len++] = code;
+    } else {
+        dprintf("add_key_byte: can't add: %02X\n", code);
+    }
+}
+
+static void key_overflow_del(uint8_t code)
+{
+    uint8_t i = 0;
+    for (; i < key_overflow_len && key_overflow[i] != code; i++)
+        ;
+    if (i == key_overflow_len) return;
+    key_overflow_len--;
+    for (; i < key_overflow_len; i++) {
+        key_overflow[i] = key_overflow[i + 1];
     }
 }
 
+static inline void add_key_byte(uint8_t code)
+{
+    if (!code || KEY_BIT_IS_ON(code)) return;
+    if (!key_slots_free) {
+        key_overflow_add(code);
+        return;
+    }
+    uint8_t i = KEY_SLOTS_FFS(key_slots_free);
+    key_slots_free &= ~((key_slots_t)1<<i);
+    keyboard_report->keys[i] = code;
+    key_bits[code>>3] |= 1<<(code&7);
+    key_count++;
+}
+
 static inline void del_key_byte(uint8_t code)
 {
-    for (uint8_t i = 0; i < REPORT_KEYS; i++) {
-        if (keyboard_report->keys[i] == code) {
-            keyboard_report->keys[i] = 0;
-        }
+    if (!KEY_BIT_IS_ON(code)) {
+        key_overflow_del(code);
+        return;
+    }
+    // only keys in report come here, at most KEYBOARD_REPORT_KEYS to look at
+    uint8_t i = 0;
+    for (; i < KEYBOARD_REPORT_KEYS && keyboard_report->keys[i] != code; i++)
+        ;
+    if (i == KEYBOARD_REPORT_KEYS) return;
+    keyboard_report->keys[i] = 0;
+    key_slots_free |= ((key_slots_t)1<<i);
+    key_bits[code>>3] &= ~(1<<(code&7));
+    key_count--;
+
+    // oldest key waiting takes the slot
+    if (key_overflow_len) {
+        uint8_t next = key_overflow[0];
+        key_overflow_del(next);
+        add_key_byte(next);
     }
 }
 
@@ -196,7 +305,10 @@ static inline void del_key_byte(uint8_t code)
 static inline void add_key_bit(uint8_t code)
 {
     if ((code>>3) < REPORT_BITS) {
-        keyboard_report->nkro.bits[code>>3] |= 1<<(code&7);
+        if (!(keyboard_report->nkro.bits[code>>3] & 1<<(code&7))) {
+            keyboard_report->nkro.bits[code>>3] |= 1<<(code&7);
+            key_count++;
+        }
     } else {
         dprintf("add_key_bit: can't add: %02X\n", code);
     }
@@ -205,7 +317,10 @@ static inline void add_key_bit(uint8_t code)
 static inline void del_key_bit(uint8_t code)
 {
     if ((code>>3) < REPORT_BITS) {
-        keyboard_report->nkro.bits[code>>3] &= ~(1<<(code&7));
+        if (keyboard_report->nkro.bits[code>>3] & 1<<(code&7)) {
+            keyboard_report->nkro.bits[code>>3] &= ~(1<<(code&7));
+            key_count--;
+        }
     } else {
         dprintf("del_key_bit: can't del: %02X\n", code);
     }
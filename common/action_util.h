@@ -18,6 +18,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define ACTION_UTIL_H
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "report.h"
 
 extern report_keyboard_t *keyboard_report;
@@ -28,6 +29,9 @@ void send_keyboard_report(void);
 void add_key(uint8_t key);
 void del_key(uint8_t key);
 void clear_keys(void);
+#ifdef NKRO_ENABLE
+void set_keyboard_nkro(bool nkro);
+#endif
 
 /* modifier */
 uint8_t get_mods(void);
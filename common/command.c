@@ -28,11 +28,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "bootloader.h"
 #include "action_layer.h"
 #include "action_util.h"
+#include "action_tapping.h"
 #include "eeconfig.h"
 #include "sleep_led.h"
 #include "led.h"
 #include "command.h"
 #include "backlight.h"
+#include "perf.h"
+#include "trace.h"
 
 #ifdef MOUSEKEY_ENABLE
 #include "mousekey.h"
@@ -115,6 +118,12 @@ static void command_common_help(void)
     print("t:	print timer count\n");
     print("s:	print status\n");
     print("e:	print eeprom config\n");
+#ifdef PERF_ENABLE
+    print("p:	print and clear perf stats\n");
+#endif
+#ifdef TRACE_ENABLE
+    print("r:	print and clear latency trace\n");
+#endif
 #ifdef NKRO_ENABLE
     print("n:	toggle NKRO\n");
 #endif
@@ -288,6 +297,15 @@ static bool command_common(uint8_t code)
 #endif
 #ifdef KEYMAP_SECTION_ENABLE
             " KEYMAP_SECTION"
+#endif
+#ifdef KEYMAP_BLOB_ENABLE
+            " KEYMAP_BLOB"
+#endif
+#ifdef COMBO_ENABLE
+            " COMBO"
+#endif
+#ifdef LEADER_ENABLE
+            " LEADER"
 #endif
             " " STR(BOOTLOADER_SIZE) "\n");
 
@@ -298,6 +316,18 @@ static bool command_common(uint8_t code)
         case KC_T: // print timer
             print_val_hex32(timer_count);
             break;
+#ifdef PERF_ENABLE
+        case KC_P: // print perf stats
+            perf_print();
+            perf_clear();
+            break;
+#endif
+#ifdef TRACE_ENABLE
+        case KC_R: // print latency trace
+            trace_print();
+            trace_clear();
+            break;
+#endif
         case KC_S:
             print("\n\n----- Status -----\n");
             print_val_hex8(host_keyboard_leds());
@@ -315,12 +345,16 @@ static bool command_common(uint8_t code)
 #   if USB_COUNT_SOF
             print_val_hex8(usbSofCount);
 #   endif
+#endif
+
+#ifndef NO_ACTION_TAPPING
+            print_val_dec(waiting_buffer_high);
+            print_val_dec(waiting_buffer_forced);
 #endif
             break;
 #ifdef NKRO_ENABLE
         case KC_N:
-            clear_keyboard(); //Prevents stuck keys.
-            keyboard_nkro = !keyboard_nkro;
+            set_keyboard_nkro(!keyboard_nkro);
             if (keyboard_nkro)
                 print("NKRO: enabled\n");
             else
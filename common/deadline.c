@@ -0,0 +1,56 @@
+/*
+ * Deadline scheduler: deadlines in a list linked in order of time
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "timer.h"
+#include "deadline.h"
+
+
+#define DEADLINE_NONE   0xFF
+
+static uint16_t deadline_time[DEADLINE_COUNT];
+static uint8_t deadline_next[DEADLINE_COUNT];
+static uint8_t deadline_head = DEADLINE_NONE;
+static uint8_t deadline_active = 0;
+
+
+void deadline_set(uint8_t id, uint16_t time)
+{
+    deadline_clear(id);
+    deadline_time[id] = time;
+    deadline_active |= DEADLINE_BIT(id);
+
+    // insert after deadlines due before or at the same time
+    uint8_t *p = &deadline_head;
+    while (*p != DEADLINE_NONE && (int16_t)(deadline_time[*p] - time) <= 0) {
+        p = &deadline_next[*p];
+    }
+    deadline_next[id] = *p;
+    *p = id;
+}
+
+void deadline_clear(uint8_t id)
+{
+    if (!(deadline_active & DEADLINE_BIT(id))) return;
+    deadline_active &= ~DEADLINE_BIT(id);
+
+    uint8_t *p = &deadline_head;
+    while (*p != id) {
+        p = &deadline_next[*p];
+    }
+    *p = deadline_next[id];
+}
+
+uint8_t deadline_poll(void)
+{
+    uint8_t due = 0;
+    if (deadline_head == DEADLINE_NONE) return due;
+
+    uint16_t now = timer_read();
+    for (uint8_t i = deadline_head; i != DEADLINE_NONE; i = deadline_next[i]) {
+        if ((int16_t)(now - deadline_time[i]) < 0) break;
+        due |= DEADLINE_BIT(i);
+    }
+    return due;
+}
@@ -0,0 +1,38 @@
+/*
+ * Deadline scheduler
+ *
+ * Timeout driven parts register time of their next wakeup instead of
+ * checking their own timer on every loop. keyboard_task() polls the list
+ * sorted by time once and calls only parts which are due.
+ *
+ * A deadline stays due until its owner sets it again or clears it.
+ * Deadlines should be within 32 seconds from now(16bit timer).
+ */
+#ifndef DEADLINE_H
+#define DEADLINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+enum deadline_id {
+    DEADLINE_TAPPING,       /* TICK event for tapping timeout */
+    DEADLINE_COMBO,         /* TICK event for COMBO_TERM */
+    DEADLINE_LEADER,        /* TICK event for LEADER_TIMEOUT */
+    DEADLINE_ONESHOT,       /* ONESHOT_TIMEOUT */
+    DEADLINE_MACRO,         /* next step of macro */
+    DEADLINE_MOUSEKEY,      /* mousekey repeat */
+    DEADLINE_PS2_MOUSE,     /* PS/2 mouse poll */
+    DEADLINE_COUNT
+};
+
+#define DEADLINE_BIT(id)    (1<<(id))
+
+
+/* wakeup at time of timer_read() */
+void deadline_set(uint8_t id, uint16_t time);
+void deadline_clear(uint8_t id);
+/* DEADLINE_BIT of deadlines whose time has come */
+uint8_t deadline_poll(void);
+
+#endif
@@ -0,0 +1,92 @@
+/*
+ * Per-key debounce with vertical counters
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "timer.h"
+#include "matrix.h"
+#include "debounce.h"
+
+
+/* bits of counter to count down DEBOUNCE-1 to 0 */
+#if DEBOUNCE > 16
+#   error "DEBOUNCE: too large value for per-key debounce"
+#elif DEBOUNCE > 8
+#   define DEBOUNCE_PLANES 4
+#elif DEBOUNCE > 4
+#   define DEBOUNCE_PLANES 3
+#elif DEBOUNCE > 2
+#   define DEBOUNCE_PLANES 2
+#else
+#   define DEBOUNCE_PLANES 1
+#endif
+
+/* plane i of counter preset: all ones where bit i of DEBOUNCE-1 is on */
+#define DEBOUNCE_PRESET(i)  ((((DEBOUNCE-1)>>(i)) & 1) ? ~(matrix_row_t)0 : 0)
+
+/* debounced state */
+static matrix_row_t state[MATRIX_ROWS];
+/* counters of keys in the row, plane 0 is LSB */
+static matrix_row_t counter[MATRIX_ROWS][DEBOUNCE_PLANES];
+
+/* counters advance once a millisecond */
+static bool tick = false;
+static uint8_t last_tick = 0;
+
+
+void debounce_init(void)
+{
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        state[r] = 0;
+        for (uint8_t i = 0; i < DEBOUNCE_PLANES; i++) {
+            counter[r][i] = DEBOUNCE_PRESET(i);
+        }
+    }
+    last_tick = timer_read();
+}
+
+void debounce_tick(void)
+{
+    uint8_t t = timer_read();
+    tick = (t != last_tick);
+    last_tick = t;
+}
+
+matrix_row_t debounce_row(uint8_t row, matrix_row_t raw)
+{
+#if DEBOUNCE == 0
+    (void)row;
+    return raw;
+#else
+    matrix_row_t *c = counter[row];
+    matrix_row_t delta = raw ^ state[row];
+
+#ifdef DEBOUNCE_EAGER_PRESS
+    // press goes through at once, its bounce is filtered by release counter
+    state[row] |= delta & raw;
+    delta &= ~raw;
+#endif
+
+    // count down keys which differ from state; borrow out of the last
+    // plane means the key has been stable for DEBOUNCE ms.
+    matrix_row_t expired = 0;
+    if (tick && delta) {
+        matrix_row_t borrow = delta;
+        for (uint8_t i = 0; i < DEBOUNCE_PLANES; i++) {
+            matrix_row_t t = c[i];
+            c[i] = t ^ borrow;
+            borrow &= ~t;
+        }
+        expired = borrow;
+        state[row] ^= expired;
+    }
+
+    // reload counters of stable and just changed keys
+    matrix_row_t reload = ~delta | expired;
+    for (uint8_t i = 0; i < DEBOUNCE_PLANES; i++) {
+        c[i] = (c[i] & ~reload) | (DEBOUNCE_PRESET(i) & reload);
+    }
+
+    return state[row];
+#endif
+}
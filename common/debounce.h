@@ -0,0 +1,30 @@
+/*
+ * Per-key debounce
+ *
+ * Each key has its own counter so that a bouncing key doesn't hold back
+ * state of other keys. Counters are vertical(bit-sliced): bit n of plane i
+ * is bit i of counter of column n, so a whole row is counted with a few
+ * word operations.
+ *
+ * DEBOUNCE(config.h):  time(ms) a change must be stable before it is taken
+ * DEBOUNCE_EAGER_PRESS(config.h): press is taken on first sample and
+ *      release after DEBOUNCE ms stable. Otherwise both are deferred.
+ */
+#ifndef DEBOUNCE_H
+#define DEBOUNCE_H
+
+#include <stdint.h>
+#include "matrix.h"
+
+
+#ifndef DEBOUNCE
+#   define DEBOUNCE 5
+#endif
+
+void debounce_init(void);
+/* call once every matrix scan before debounce_row() */
+void debounce_tick(void);
+/* debounced state of the row from its raw sample */
+matrix_row_t debounce_row(uint8_t row, matrix_row_t raw);
+
+#endif
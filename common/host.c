@@ -21,20 +21,41 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "host.h"
 #include "util.h"
 #include "debug.h"
+#include "perf.h"
 
 
 #ifdef NKRO_ENABLE
 bool keyboard_nkro = false;
 #endif
 
+#ifdef NKRO_ENABLE
+#define KEYBOARD_ENDPOINT   keyboard_nkro
+#define KEYBOARD_ENDPOINTS  2
+#else
+#define KEYBOARD_ENDPOINT   0
+#define KEYBOARD_ENDPOINTS  1
+#endif
+
 static host_driver_t *driver;
+/* last report of each keyboard endpoint, 6KRO and NKRO */
+static report_keyboard_t last_keyboard_report[KEYBOARD_ENDPOINTS];
+static report_mouse_t last_mouse_report;
+static bool last_keyboard_report_valid[KEYBOARD_ENDPOINTS];
+static bool last_mouse_report_valid = false;
 static uint16_t last_system_report = 0;
 static uint16_t last_consumer_report = 0;
 
+static bool report_equal(const void *a, const void *b, uint8_t size);
+
 
 void host_set_driver(host_driver_t *d)
 {
     driver = d;
+    // new driver gets first reports whatever they are
+    for (uint8_t i = 0; i < KEYBOARD_ENDPOINTS; i++) {
+        last_keyboard_report_valid[i] = false;
+    }
+    last_mouse_report_valid = false;
 }
 
 host_driver_t *host_get_driver(void)
@@ -51,7 +72,12 @@ uint8_t host_keyboard_leds(void)
 void host_keyboard_send(report_keyboard_t *report)
 {
     if (!driver) return;
-    (*driver->send_keyboard)(report);
+    uint8_t ep = KEYBOARD_ENDPOINT;
+    if (last_keyboard_report_valid[ep] && report_equal(report, &last_keyboard_report[ep], sizeof(report_keyboard_t))) return;
+    last_keyboard_report[ep] = *report;
+    last_keyboard_report_valid[ep] = true;
+
+    PERF_MEASURE(PERF_HOST_SEND, (*driver->send_keyboard)(report));
 
     if (debug_keyboard) {
         dprint("keyboard_report: ");
@@ -65,7 +91,24 @@ void host_keyboard_send(report_keyboard_t *report)
 void host_mouse_send(report_mouse_t *report)
 {
     if (!driver) return;
-    (*driver->send_mouse)(report);
+    // report with movement is relative and not redundant even if same
+    if (last_mouse_report_valid && !report->x && !report->y && !report->v && !report->h &&
+            report_equal(report, &last_mouse_report, sizeof(report_mouse_t))) return;
+    last_mouse_report = *report;
+    last_mouse_report_valid = true;
+
+    PERF_MEASURE(PERF_HOST_SEND, (*driver->send_mouse)(report));
+}
+
+/* driver could not send the report, next one goes to host even if same */
+void host_keyboard_dropped(void)
+{
+    last_keyboard_report_valid[KEYBOARD_ENDPOINT] = false;
+}
+
+void host_mouse_dropped(void)
+{
+    last_mouse_report_valid = false;
 }
 
 void host_system_send(uint16_t report)
@@ -74,7 +117,7 @@ void host_system_send(uint16_t report)
     last_system_report = report;
 
     if (!driver) return;
-    (*driver->send_system)(report);
+    PERF_MEASURE(PERF_HOST_SEND, (*driver->send_system)(report));
 }
 
 void host_consumer_send(uint16_t report)
@@ -83,7 +126,7 @@ void host_consumer_send(uint16_t report)
     last_consumer_report = report;
 
     if (!driver) return;
-    (*driver->send_consumer)(report);
+    PERF_MEASURE(PERF_HOST_SEND, (*driver->send_consumer)(report));
 }
 
 uint16_t host_last_sysytem_report(void)
@@ -95,3 +138,12 @@ uint16_t host_last_consumer_report(void)
 {
     return last_consumer_report;
 }
+
+static bool report_equal(const void *a, const void *b, uint8_t size)
+{
+    const uint8_t *p = a, *q = b;
+    while (size--) {
+        if (*p++ != *q++) return false;
+    }
+    return true;
+}
@@ -44,6 +44,10 @@ void host_mouse_send(report_mouse_t *report);
 void host_system_send(uint16_t data);
 void host_consumer_send(uint16_t data);
 
+/* called by driver when it drops report to keep host in sync */
+void host_keyboard_dropped(void);
+void host_mouse_dropped(void);
+
 uint16_t host_last_sysytem_report(void);
 uint16_t host_last_consumer_report(void);
 
@@ -31,6 +31,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "bootmagic.h"
 #include "eeconfig.h"
 #include "backlight.h"
+#include "perf.h"
+#include "trace.h"
+#include "deadline.h"
+#include "action_util.h"
+#include "action_combo.h"
 #ifdef MOUSEKEY_ENABLE
 #   include "mousekey.h"
 #endif
@@ -40,38 +45,105 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef TRACKPOINT_ENABLE
 #   include "trackpoint.h"
 #endif
+#ifdef KEYMAP_BLOB_ENABLE
+#   include "keymap_blob.h"
+#endif
+
+/* lowest changed column of a matrix row */
+#if (MATRIX_COLS <= 8)
+#   define MATRIX_ROW_FFS(bits)     bitffs(bits)
+#elif (MATRIX_COLS <= 16)
+#   define MATRIX_ROW_FFS(bits)     bitffs16(bits)
+#else
+#   define MATRIX_ROW_FFS(bits)     bitffs32(bits)
+#endif
+
+/* lowest row of a bit array of rows */
+#if (MATRIX_ROWS <= 8)
+#   define MATRIX_ROWS_FFS(bits)    bitffs(bits)
+#elif (MATRIX_ROWS <= 16)
+#   define MATRIX_ROWS_FFS(bits)    bitffs16(bits)
+#else
+#   define MATRIX_ROWS_FFS(bits)    bitffs32(bits)
+#endif
+#define MATRIX_ROWS_ALL     ((matrix_row_bits_t)~0 >> (sizeof(matrix_row_bits_t)*8 - MATRIX_ROWS))
+
+/* time(ms) of the latest matrix_scan() */
+static uint16_t scan_time = 0;
 
 #ifdef PS2_MOUSE_ENABLE
-static uint32_t ps2_mouse_poll_time = 0;
 static int ps2_mouse_poll_interval = 10; // milliseconds
 #endif
 
 #ifdef MATRIX_HAS_GHOST
-static bool has_ghost_in_row(uint8_t row)
+/* rows whose changes are held back while they may have ghost */
+static matrix_row_bits_t ghost_rows = 0;
+/* columns which have keys down on two or more rows, built every scan */
+static matrix_row_t ghost_cols = 0;
+
+static void update_ghost_cols(void)
+{
+    matrix_row_t once = 0;
+    matrix_row_t multi = 0;
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        matrix_row_t matrix_row = matrix_get_row(r);
+        multi |= once & matrix_row;
+        once |= matrix_row;
+    }
+    ghost_cols = multi;
+}
+
+static bool has_ghost_in_row(matrix_row_t matrix_row)
 {
-    matrix_row_t matrix_row = matrix_get_row(row);
     // No ghost exists when less than 2 keys are down on the row
     if (((matrix_row - 1) & matrix_row) == 0)
         return false;
 
     // Ghost occurs when the row shares column line with other row
-    for (uint8_t i=0; i < MATRIX_ROWS; i++) {
-        if (i != row && (matrix_get_row(i) & matrix_row))
-            return true;
-    }
-    return false;
+    return (matrix_row & ghost_cols);
 }
 #endif
 
+matrix_row_bits_t keyboard_ghost_rows(void)
+{
+#ifdef MATRIX_HAS_GHOST
+    return ghost_rows;
+#else
+    return 0;
+#endif
+}
+
+
+/* Matrix drivers which don't track changes get all rows checked */
+__attribute__ ((weak))
+matrix_row_bits_t matrix_changed_rows(void)
+{
+    return MATRIX_ROWS_ALL;
+}
+
+/* Matrix drivers which don't record sample time get time of the scan */
+__attribute__ ((weak))
+uint16_t matrix_get_row_time(uint8_t row)
+{
+    return scan_time;
+}
+
 
 void keyboard_init(void)
 {
     timer_init();
     matrix_init();
 
+#ifdef KEYMAP_BLOB_ENABLE
+    keymap_blob_init();
+#endif
+#ifdef COMBO_ENABLE
+    action_combo_init();
+#endif
+
 #ifdef PS2_MOUSE_ENABLE
     ps2_mouse_init();
-	ps2_mouse_poll_time = timer_read32();
+	deadline_set(DEADLINE_PS2_MOUSE, timer_read() + ps2_mouse_poll_interval);
 #endif
 
 #ifdef TRACKPOINT_ENABLE
@@ -80,6 +152,7 @@ void keyboard_init(void)
 
 #ifdef BOOTMAGIC_ENABLE
     bootmagic();
+    keymap_config_update();
 #endif
 
 #ifdef BACKLIGHT_ENABLE
@@ -95,51 +168,115 @@ void keyboard_init(void)
 void keyboard_task(void)
 {
     static matrix_row_t matrix_prev[MATRIX_ROWS];
+    // rows to check besides changed ones: all at first to catch keys held
+    // since startup(bootmagic scans matrix), and rows blocked by ghost
+    static matrix_row_bits_t pending_rows = MATRIX_ROWS_ALL;
     static uint8_t led_status = 0;
+    static uint16_t last_time = 0;
     matrix_row_t matrix_row = 0;
     matrix_row_t matrix_change = 0;
+    bool has_event = false;
 
-    matrix_scan();
-    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+    PERF_MEASURE(PERF_MATRIX_SCAN, matrix_scan());
+    matrix_row_bits_t rows = matrix_changed_rows() | pending_rows;
+    pending_rows = 0;
+    scan_time = timer_read();
+    // keep last_time within range of 16bit time comparison
+    if ((uint16_t)(scan_time - last_time) > 0x4000) {
+        last_time = scan_time - 0x4000;
+    }
+#ifdef MATRIX_HAS_GHOST
+    if (rows) update_ghost_cols();
+#endif
+    while (rows) {
+        uint8_t r = MATRIX_ROWS_FFS(rows);
+        rows &= rows - 1;
         matrix_row = matrix_get_row(r);
         matrix_change = matrix_row ^ matrix_prev[r];
         if (matrix_change) {
             if (debug_matrix) matrix_print();
 #ifdef MATRIX_HAS_GHOST
-            if (has_ghost_in_row(r)) {
-                matrix_prev[r] = matrix_row;
+            // block the row until ghost is gone, its changes are processed then
+            if (has_ghost_in_row(matrix_row)) {
+                if (!(ghost_rows & ((matrix_row_bits_t)1<<r))) {
+                    debug("ghost: "); debug_hex(r); debug("\n");
+                }
+                ghost_rows |= ((matrix_row_bits_t)1<<r);
+                pending_rows |= ((matrix_row_bits_t)1<<r);
                 continue;
             }
+            ghost_rows &= ~((matrix_row_bits_t)1<<r);
 #endif
-            for (uint8_t c = 0; c < MATRIX_COLS; c++) {
-                if (matrix_change & ((matrix_row_t)1<<c)) {
-                    action_exec((keyevent_t){
-                        .key = (key_t){ .row = r, .col = c },
-                        .pressed = (matrix_row & ((matrix_row_t)1<<c)),
-                        .time = (timer_read() || 1) /* time should not be 0 */
-                    });
-                    // record a processed key
-                    matrix_prev[r] ^= ((matrix_row_t)1<<c);
-                    // process a key per task call
-                    goto MATRIX_LOOP_END;
-                }
+            // events carry sample time of the row, kept in order of processing
+            uint16_t time = matrix_get_row_time(r);
+            if ((int16_t)(time - last_time) < 0) {
+                time = last_time;
             }
+            last_time = time;
+
+            // process all changed keys of this scan in row/column order
+            do {
+                // no room to defer during macro: leave the change to later scan
+                if (action_macro_busy()) {
+                    pending_rows |= ((matrix_row_bits_t)1<<r);
+                    break;
+                }
+                uint8_t c = MATRIX_ROW_FFS(matrix_change);
+                keyevent_t event = {
+                    .key = (key_t){ .row = r, .col = c },
+                    .pressed = (matrix_row & ((matrix_row_t)1<<c)),
+                    .time = (time | 1) /* time should not be 0 */
+                };
+#ifdef TRACE_ENABLE
+                event.trace_id = trace_new_id();
+                trace_record(event.trace_id, TRACE_SAMPLE, time * (TIMER_RAW_TOP + 1));
+                TRACE_STAMP(event.trace_id, TRACE_SETTLE);
+#endif
+                PERF_MEASURE(PERF_ACTION_EXEC, action_exec(event));
+                // record processed key
+                matrix_prev[r] ^= ((matrix_row_t)1<<c);
+                matrix_change &= matrix_change - 1;
+                has_event = true;
+            } while (matrix_change);
         }
     }
-    // call with pseudo tick event when no real key event.
-    action_exec(TICK);
+    // only timeout driven jobs which are due are called
+    uint8_t due = deadline_poll();
 
-MATRIX_LOOP_END:
+    // call with pseudo tick event when no real key event and tapping, combo or leader may time out
+    if (!has_event && (due & (DEADLINE_BIT(DEADLINE_TAPPING) | DEADLINE_BIT(DEADLINE_COMBO) |
+                              DEADLINE_BIT(DEADLINE_LEADER)))) {
+        PERF_MEASURE(PERF_ACTION_EXEC, action_exec(TICK));
+    }
+
+    // macro steps and key events deferred by macro
+    if (due & DEADLINE_BIT(DEADLINE_MACRO)) {
+        action_macro_task();
+    }
+
+#if !defined(NO_ACTION_ONESHOT) && defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0)
+    // report without oneshot modifier at timeout
+    if (due & DEADLINE_BIT(DEADLINE_ONESHOT)) {
+        send_keyboard_report();
+        deadline_clear(DEADLINE_ONESHOT);
+    }
+#endif
+#ifdef TRACE_ENABLE
+    // reports sent out of key event processing are not traced
+    trace_id = 0;
+#endif
 
 #ifdef MOUSEKEY_ENABLE
     // mousekey repeat & acceleration
-    mousekey_task();
+    if (due & DEADLINE_BIT(DEADLINE_MOUSEKEY)) {
+        PERF_MEASURE(PERF_MOUSEKEY_TASK, mousekey_task());
+    }
 #endif
 
 #ifdef PS2_MOUSE_ENABLE
-	if ( timer_elapsed32( ps2_mouse_poll_time ) >= ps2_mouse_poll_interval ) {
-		ps2_mouse_task();
-		ps2_mouse_poll_time = timer_read32();
+	if ( due & DEADLINE_BIT( DEADLINE_PS2_MOUSE ) ) {
+		PERF_MEASURE(PERF_PS2_MOUSE_TASK, ps2_mouse_task());
+		deadline_set( DEADLINE_PS2_MOUSE, timer_read() + ps2_mouse_poll_interval );
 	}
 #endif
 
@@ -20,6 +20,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <stdbool.h>
 #include <stdint.h>
+#include "matrix.h"
 
 
 #ifdef __cplusplus
@@ -36,7 +37,10 @@ typedef struct {
 typedef struct {
     key_t    key;
     bool     pressed;
-    uint16_t time;
+    uint16_t time;      /* time(ms) when the switch was sampled */
+#ifdef TRACE_ENABLE
+    uint8_t  trace_id;  /* id of the event in latency trace */
+#endif
 } keyevent_t;
 
 /* equivalent test of key_t */
@@ -61,6 +65,8 @@ static inline bool IS_RELEASED(keyevent_t event) { return (!IS_NOEVENT(event) &&
 void keyboard_init(void);
 void keyboard_task(void);
 void keyboard_set_leds(uint8_t leds);
+/* rows held back from action because of possible ghost(MATRIX_HAS_GHOST) */
+matrix_row_bits_t keyboard_ghost_rows(void);
 
 #ifdef __cplusplus
 }
@@ -27,84 +27,72 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 static action_t keycode_to_action(uint8_t keycode);
 
 
+#ifdef BOOTMAGIC_ENABLE
+/* keycode replaced by keymap_config, indexed by keycode */
+static uint8_t keycode_remap[256];
+
+void keymap_config_update(void)
+{
+    uint8_t i = 0;
+    do {
+        keycode_remap[i] = i;
+    } while (++i);
+
+    if (keymap_config.swap_control_capslock || keymap_config.capslock_to_control) {
+        keycode_remap[KC_CAPSLOCK] = KC_LCTL;
+        keycode_remap[KC_LOCKING_CAPS] = KC_LCTL;
+    }
+    if (keymap_config.swap_control_capslock) {
+        keycode_remap[KC_LCTL] = KC_CAPSLOCK;
+    }
+    if (keymap_config.no_gui) {
+        keycode_remap[KC_LGUI] = KC_NO;
+        keycode_remap[KC_RGUI] = KC_NO;
+    }
+    if (keymap_config.swap_lalt_lgui) {
+        keycode_remap[KC_LALT] = keycode_remap[KC_LGUI];
+        keycode_remap[KC_LGUI] = KC_LALT;
+    }
+    if (keymap_config.swap_ralt_rgui) {
+        keycode_remap[KC_RALT] = keycode_remap[KC_RGUI];
+        keycode_remap[KC_RGUI] = KC_RALT;
+    }
+    if (keymap_config.swap_grave_esc) {
+        keycode_remap[KC_GRAVE] = KC_ESC;
+        keycode_remap[KC_ESC] = KC_GRAVE;
+    }
+    if (keymap_config.swap_backslash_backspace) {
+        keycode_remap[KC_BSLASH] = KC_BSPACE;
+        keycode_remap[KC_BSPACE] = KC_BSLASH;
+    }
+
+    action_cache_clear();
+}
+#endif
+
 /* converts key to action */
 action_t action_for_key(uint8_t layer, key_t key)
 {
     uint8_t keycode = keymap_key_to_keycode(layer, key);
+#ifdef BOOTMAGIC_ENABLE
+    keycode = keycode_remap[keycode];
+#endif
     switch (keycode) {
         case KC_FN0 ... KC_FN31:
             return keymap_fn_to_action(keycode);
-#ifdef BOOTMAGIC_ENABLE
-        case KC_CAPSLOCK:
-        case KC_LOCKING_CAPS:
-            if (keymap_config.swap_control_capslock || keymap_config.capslock_to_control) {
-                return keycode_to_action(KC_LCTL);
-            }
-            return keycode_to_action(keycode);
-        case KC_LCTL:
-            if (keymap_config.swap_control_capslock) {
-                return keycode_to_action(KC_CAPSLOCK);
-            }
-            return keycode_to_action(KC_LCTL);
-        case KC_LALT:
-            if (keymap_config.swap_lalt_lgui) {
-                if (keymap_config.no_gui) {
-                    return keycode_to_action(ACTION_NO);
-                }
-                return keycode_to_action(KC_LGUI);
-            }
-            return keycode_to_action(KC_LALT);
-        case KC_LGUI:
-            if (keymap_config.swap_lalt_lgui) {
-                return keycode_to_action(KC_LALT);
-            }
-            if (keymap_config.no_gui) {
-                return keycode_to_action(ACTION_NO);
-            }
-            return keycode_to_action(KC_LGUI);
-        case KC_RALT:
-            if (keymap_config.swap_ralt_rgui) {
-                if (keymap_config.no_gui) {
-                    return keycode_to_action(ACTION_NO);
-                }
-                return keycode_to_action(KC_RGUI);
-            }
-            return keycode_to_action(KC_RALT);
-        case KC_RGUI:
-            if (keymap_config.swap_ralt_rgui) {
-                return keycode_to_action(KC_RALT);
-            }
-            if (keymap_config.no_gui) {
-                return keycode_to_action(ACTION_NO);
-            }
-            return keycode_to_action(KC_RGUI);
-        case KC_GRAVE:
-            if (keymap_config.swap_grave_esc) {
-                return keycode_to_action(KC_ESC);
-            }
-            return keycode_to_action(KC_GRAVE);
-        case KC_ESC:
-            if (keymap_config.swap_grave_esc) {
-                return keycode_to_action(KC_GRAVE);
-            }
-            return keycode_to_action(KC_ESC);
-        case KC_BSLASH:
-            if (keymap_config.swap_backslash_backspace) {
-                return keycode_to_action(KC_BSPACE);
-            }
-            return keycode_to_action(KC_BSLASH);
-        case KC_BSPACE:
-            if (keymap_config.swap_backslash_backspace) {
-                return keycode_to_action(KC_BSLASH);
-            }
-            return keycode_to_action(KC_BSPACE);
-#endif
         default:
             return keycode_to_action(keycode);
     }
 }
 
 
+/* Layers to look up: all by default */
+__attribute__ ((weak))
+uint32_t keymap_key_layers(key_t key)
+{
+    return 0xFFFFFFFF;
+}
+
 /* Macro */
 __attribute__ ((weak))
 const macro_t *action_get_macro(keyrecord_t *record, uint8_t id, uint8_t opt)
@@ -39,12 +39,18 @@ typedef union {
     };
 } keymap_config_t;
 keymap_config_t keymap_config;
+
+/* rebuild keycode remap table, call after change of keymap_config */
+void keymap_config_update(void);
 #endif
 
 
 /* translates key to keycode */
 uint8_t keymap_key_to_keycode(uint8_t layer, key_t key);
 
+/* layers on which keycode of the key may not be transparent */
+uint32_t keymap_key_layers(key_t key);
+
 /* translates Fn keycode to action */
 action_t keymap_fn_to_action(uint8_t keycode);
 
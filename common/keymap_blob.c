@@ -0,0 +1,100 @@
+/*
+ * Keymap blob: loader of keymap in .keymap region
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/pgmspace.h>
+#include "keycode.h"
+#include "keymap.h"
+#include "action_layer.h"
+#include "keymap_blob.h"
+
+
+#ifdef SPARSE_KEYMAP_ENABLE
+#   error "KEYMAP_BLOB_ENABLE: can't be used with SPARSE_KEYMAP_ENABLE"
+#endif
+#ifdef KEYMAP_SECTION_ENABLE
+#   error "KEYMAP_BLOB_ENABLE: can't be used with KEYMAP_SECTION_ENABLE, both use .keymap region"
+#endif
+
+#define KEYMAP_SIZE     (MATRIX_ROWS * MATRIX_COLS)
+
+/* .keymap region of ldscript_keymap_avr5.x, firmware leaves it as it is */
+extern const uint8_t __keymap_start[];
+#define keymap_blob __keymap_start
+
+static bool blob_valid = false;
+static uint8_t blob_layers = 0;
+static uint8_t blob_fn_count = 0;
+static const uint8_t *blob_keymaps;
+
+#if (KEYMAP_BLOB_RAM_LAYERS > 0)
+static uint8_t ram_layers[KEYMAP_BLOB_RAM_LAYERS][MATRIX_ROWS][MATRIX_COLS];
+static uint8_t ram_count = 0;
+#endif
+
+
+static bool blob_check(const keymap_blob_header_t *h)
+{
+    if (h->magic != KEYMAP_BLOB_MAGIC || h->version != KEYMAP_BLOB_VERSION) return false;
+    if (h->rows != MATRIX_ROWS || h->cols != MATRIX_COLS) return false;
+    if (h->layers == 0 || h->layers > 32 || h->fn_count > 32) return false;
+    if (h->size != h->fn_count * 2 + h->layers * KEYMAP_SIZE ||
+            h->size > KEYMAP_BLOB_SIZE - sizeof(keymap_blob_header_t)) return false;
+
+    uint16_t crc = 0xFFFF;
+    for (uint16_t i = 0; i < h->size; i++) {
+        crc = keymap_blob_crc(crc, pgm_read_byte(&keymap_blob[sizeof(keymap_blob_header_t) + i]));
+    }
+    return crc == h->crc;
+}
+
+bool keymap_blob_init(void)
+{
+    keymap_blob_header_t h;
+    memcpy_P(&h, keymap_blob, sizeof(h));
+
+    blob_valid = blob_check(&h);
+    if (blob_valid) {
+        blob_layers = h.layers;
+        blob_fn_count = h.fn_count;
+        blob_keymaps = &keymap_blob[sizeof(h) + h.fn_count * 2];
+#if (KEYMAP_BLOB_RAM_LAYERS > 0)
+        ram_count = (blob_layers < KEYMAP_BLOB_RAM_LAYERS ? blob_layers : KEYMAP_BLOB_RAM_LAYERS);
+        memcpy_P(ram_layers, blob_keymaps, ram_count * KEYMAP_SIZE);
+#endif
+    }
+    // actions of compiled keymap may be cached already
+    action_cache_clear();
+    return blob_valid;
+}
+
+bool keymap_blob_valid(void)
+{
+    return blob_valid;
+}
+
+uint8_t keymap_blob_key_to_keycode(uint8_t layer, key_t key)
+{
+    // TICK event is looked up too
+    if (key.row >= MATRIX_ROWS || key.col >= MATRIX_COLS) {
+        return KC_NO;
+    }
+#if (KEYMAP_BLOB_RAM_LAYERS > 0)
+    if (layer < ram_count) {
+        return ram_layers[layer][key.row][key.col];
+    }
+#endif
+    if (layer >= blob_layers) {
+        return KC_TRNS;
+    }
+    return pgm_read_byte(&blob_keymaps[layer * KEYMAP_SIZE + key.row * MATRIX_COLS + key.col]);
+}
+
+action_t keymap_blob_fn_to_action(uint8_t keycode)
+{
+    if (FN_INDEX(keycode) >= blob_fn_count) {
+        return (action_t){ .code = ACTION_NO };
+    }
+    return (action_t){ .code = pgm_read_word(&keymap_blob[sizeof(keymap_blob_header_t) + FN_INDEX(keycode) * 2]) };
+}
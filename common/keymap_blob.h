@@ -0,0 +1,68 @@
+/*
+ * Keymap blob
+ *
+ * Keymap read from .keymap region of flash(ldscript_keymap_avr5.x), which
+ * can be written alone without rebuilding firmware. The blob is checked at
+ * startup and compiled keymap is used instead when it is not valid.
+ *
+ * Format version 1, little endian:
+ *   keymap_blob_header_t
+ *   uint16_t fn_actions[fn_count]
+ *   uint8_t  keymaps[layers][rows][cols]
+ * crc is CRC-16/CCITT(initial 0xFFFF) of the data after header.
+ *
+ * KEYMAP_BLOB_RAM_LAYERS(config.h): number of lowest layers copied to RAM
+ * at startup, 0 by default
+ */
+#ifndef KEYMAP_BLOB_H
+#define KEYMAP_BLOB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "keyboard.h"
+#include "action.h"
+
+
+#define KEYMAP_BLOB_MAGIC       0x4B54  /* "TK" */
+#define KEYMAP_BLOB_VERSION     1
+
+/* size of .keymap region */
+#ifndef KEYMAP_BLOB_SIZE
+#   define KEYMAP_BLOB_SIZE     2048
+#endif
+
+#ifndef KEYMAP_BLOB_RAM_LAYERS
+#   define KEYMAP_BLOB_RAM_LAYERS   0
+#endif
+
+typedef struct {
+    uint16_t magic;
+    uint8_t  version;
+    uint8_t  layers;
+    uint8_t  rows;
+    uint8_t  cols;
+    uint8_t  fn_count;
+    uint8_t  reserved;
+    uint16_t size;      /* bytes of data after header */
+    uint16_t crc;
+} keymap_blob_header_t;
+
+
+/* checks blob and loads RAM layers, returns true if blob is used */
+bool keymap_blob_init(void);
+bool keymap_blob_valid(void);
+
+/* lookups in blob, only when keymap_blob_valid() */
+uint8_t keymap_blob_key_to_keycode(uint8_t layer, key_t key);
+action_t keymap_blob_fn_to_action(uint8_t keycode);
+
+static inline uint16_t keymap_blob_crc(uint16_t crc, uint8_t data)
+{
+    crc ^= (uint16_t)data << 8;
+    for (uint8_t i = 0; i < 8; i++) {
+        crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+    }
+    return crc;
+}
+
+#endif
@@ -0,0 +1,49 @@
+/*
+ * Sparse keymap: keymap_key_to_keycode() and keymap_key_layers() on
+ * tables of keymap_sparse.h
+ */
+#include <stdint.h>
+#include <avr/pgmspace.h>
+#include "keycode.h"
+#include "keymap.h"
+#include "util.h"
+#include "keymap_sparse.h"
+
+
+#if (MATRIX_COLS <= 8)
+#   define pgm_read_row(p)  pgm_read_byte(p)
+#   define row_bitpop(bits) bitpop(bits)
+#elif (MATRIX_COLS <= 16)
+#   define pgm_read_row(p)  pgm_read_word(p)
+#   define row_bitpop(bits) bitpop16(bits)
+#else
+#   define pgm_read_row(p)  pgm_read_dword(p)
+#   define row_bitpop(bits) bitpop32(bits)
+#endif
+
+#if (SPARSE_KEYMAP_LAYERS <= 8)
+#   define pgm_read_layers(p)   pgm_read_byte(p)
+#elif (SPARSE_KEYMAP_LAYERS <= 16)
+#   define pgm_read_layers(p)   pgm_read_word(p)
+#else
+#   define pgm_read_layers(p)   pgm_read_dword(p)
+#endif
+
+
+uint8_t keymap_key_to_keycode(uint8_t layer, key_t key)
+{
+    if (layer >= SPARSE_KEYMAP_LAYERS ||
+            !(pgm_read_layers(&sparse_keymap_layers[key.row][key.col]) & ((sparse_layers_t)1<<layer))) {
+        return KC_TRNS;
+    }
+    matrix_row_t bits = pgm_read_row(&sparse_keymap_rows[layer][key.row]);
+    uint16_t i = pgm_read_word(&sparse_keymap_index[layer][key.row]);
+    // count keys stored before this column
+    i += row_bitpop(bits & (((matrix_row_t)1<<key.col) - 1));
+    return pgm_read_byte(&sparse_keymap_codes[i]);
+}
+
+uint32_t keymap_key_layers(key_t key)
+{
+    return pgm_read_layers(&sparse_keymap_layers[key.row][key.col]);
+}
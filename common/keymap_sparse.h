@@ -0,0 +1,41 @@
+/*
+ * Sparse keymap
+ *
+ * Keymap layers stored without transparent keys. Tables are generated from
+ * keymaps[] of a keymap file with 'make -C sim KEYMAP=<name> sparse':
+ *
+ * sparse_keymap_rows[layer][row]:      bitmap of non-transparent keys
+ * sparse_keymap_index[layer][row]:     position of first key of the row in codes
+ * sparse_keymap_codes[]:               keycodes of non-transparent keys in order
+ * sparse_keymap_layers[row][col]:      bitmap of layers the key is not transparent on
+ *
+ * SPARSE_KEYMAP_LAYERS(config.h): maximum number of layers, 8 by default
+ */
+#ifndef KEYMAP_SPARSE_H
+#define KEYMAP_SPARSE_H
+
+#include <stdint.h>
+#include <avr/pgmspace.h>
+#include "matrix.h"
+
+
+#ifndef SPARSE_KEYMAP_LAYERS
+#   define SPARSE_KEYMAP_LAYERS 8
+#endif
+
+#if (SPARSE_KEYMAP_LAYERS <= 8)
+typedef uint8_t     sparse_layers_t;
+#elif (SPARSE_KEYMAP_LAYERS <= 16)
+typedef uint16_t    sparse_layers_t;
+#elif (SPARSE_KEYMAP_LAYERS <= 32)
+typedef uint32_t    sparse_layers_t;
+#else
+#error "SPARSE_KEYMAP_LAYERS: invalid value"
+#endif
+
+extern const matrix_row_t sparse_keymap_rows[][MATRIX_ROWS];
+extern const uint16_t sparse_keymap_index[][MATRIX_ROWS];
+extern const uint8_t sparse_keymap_codes[];
+extern const sparse_layers_t sparse_keymap_layers[MATRIX_ROWS][MATRIX_COLS];
+
+#endif
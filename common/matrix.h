@@ -32,6 +32,17 @@ typedef  uint32_t   matrix_row_t;
 #error "MATRIX_COLS: invalid value"
 #endif
 
+/* bit array of rows */
+#if (MATRIX_ROWS <= 8)
+typedef  uint8_t    matrix_row_bits_t;
+#elif (MATRIX_ROWS <= 16)
+typedef  uint16_t   matrix_row_bits_t;
+#elif (MATRIX_ROWS <= 32)
+typedef  uint32_t   matrix_row_bits_t;
+#else
+#error "MATRIX_ROWS: invalid value"
+#endif
+
 #define MATRIX_IS_ON(row, col)  (matrix_get_row(row) && (1<<col))
 
 
@@ -49,6 +60,10 @@ bool matrix_is_modified(void) __attribute__ ((deprecated));
 bool matrix_is_on(uint8_t row, uint8_t col);
 /* matrix state on row */
 matrix_row_t  matrix_get_row(uint8_t row);
+/* time(ms) when the row was sampled in its current state */
+uint16_t matrix_get_row_time(uint8_t row);
+/* rows whose state changed in the last matrix_scan(), optional */
+matrix_row_bits_t matrix_changed_rows(void);
 /* print matrix for debug */
 void matrix_print(void);
 
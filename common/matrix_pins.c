@@ -0,0 +1,264 @@
+/*
+ * Matrix driver built from pin table of config.h
+ *
+ * Rows are driven low one by one and columns are read with pull-up.
+ * Each port of columns is read once per row, and column pins are given as
+ * runs of ascending bits of a port which take a mask and a shift of the
+ * port value instead of a branch per pin.
+ *
+ * config.h:
+ *  MATRIX_ROW_PINS:  MATRIX_ROW_PIN(port, bit) for each row, comma separated
+ *  MATRIX_COL_PORTS: MATRIX_COL_PORT(port) for each port of column pins
+ *  MATRIX_COL_PINS:  MATRIX_COL_RUN(port, first bit, bits, first column)
+ *                    Columns given more than once are on when any pin is low.
+ *
+ *  #define MATRIX_ROW_PINS MATRIX_ROW_PIN(D, 0), MATRIX_ROW_PIN(D, 1)
+ *  #define MATRIX_COL_PORTS MATRIX_COL_PORT(B) MATRIX_COL_PORT(F)
+ *  #define MATRIX_COL_PINS MATRIX_COL_RUN(F, 4, 4, 0) MATRIX_COL_RUN(B, 6, 1, 4)
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/io.h>
+#include <util/delay.h>
+#include "print.h"
+#include "debug.h"
+#include "util.h"
+#include "timer.h"
+#include "matrix.h"
+#ifdef PER_KEY_DEBOUNCE_ENABLE
+#include "debounce.h"
+#endif
+
+
+#if !defined(MATRIX_ROW_PINS) || !defined(MATRIX_COL_PORTS) || !defined(MATRIX_COL_PINS)
+#   error "MATRIX_ROW_PINS, MATRIX_COL_PORTS and MATRIX_COL_PINS are needed in config.h"
+#endif
+
+#ifndef DEBOUNCE
+#   define DEBOUNCE	5
+#endif
+#ifndef PER_KEY_DEBOUNCE_ENABLE
+static uint8_t debouncing = DEBOUNCE;
+#endif
+
+/* matrix state(1:on, 0:off) */
+static matrix_row_t matrix[MATRIX_ROWS];
+static matrix_row_t matrix_debouncing[MATRIX_ROWS];
+/* time(ms) when row started to change */
+static uint16_t matrix_time[MATRIX_ROWS];
+static uint16_t matrix_debouncing_time[MATRIX_ROWS];
+/* rows changed in the last scan */
+static matrix_row_bits_t matrix_changed;
+
+static matrix_row_t read_cols(void);
+static void init_cols(void);
+static void unselect_rows(void);
+static void unselect_row(uint8_t row);
+static void select_row(uint8_t row);
+
+
+/* row pin */
+typedef struct {
+    volatile uint8_t *ddr;
+    volatile uint8_t *port;
+    uint8_t mask;
+} row_pin_t;
+
+#define MATRIX_ROW_PIN(port, bit)   { &DDR##port, &PORT##port, (1<<(bit)) }
+static const row_pin_t row_pins[MATRIX_ROWS] = { MATRIX_ROW_PINS };
+
+
+inline
+uint8_t matrix_rows(void)
+{
+    return MATRIX_ROWS;
+}
+
+inline
+uint8_t matrix_cols(void)
+{
+    return MATRIX_COLS;
+}
+
+void matrix_init(void)
+{
+    // initialize row and col
+    unselect_rows();
+    init_cols();
+
+    // initialize matrix state: all keys off
+    for (uint8_t i=0; i < MATRIX_ROWS; i++) {
+        matrix[i] = 0;
+        matrix_debouncing[i] = 0;
+    }
+#ifdef PER_KEY_DEBOUNCE_ENABLE
+    debounce_init();
+#endif
+}
+
+uint8_t matrix_scan(void)
+{
+    matrix_changed = 0;
+#ifdef PER_KEY_DEBOUNCE_ENABLE
+    debounce_tick();
+#endif
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+        select_row(i);
+        _delay_us(30);  // without this wait read unstable value.
+        matrix_row_t cols = read_cols();
+        if (matrix_debouncing[i] != cols) {
+            if (matrix_debouncing[i] == matrix[i]) {
+                matrix_debouncing_time[i] = timer_read();
+            }
+            matrix_debouncing[i] = cols;
+#ifndef PER_KEY_DEBOUNCE_ENABLE
+            if (debouncing) {
+                debug("bounce!: "); debug_hex(debouncing); debug("\n");
+            }
+            debouncing = DEBOUNCE;
+#endif
+        }
+#ifdef PER_KEY_DEBOUNCE_ENABLE
+        matrix_row_t row = debounce_row(i, cols);
+        if (matrix[i] != row) {
+            matrix_time[i] = matrix_debouncing_time[i];
+            matrix[i] = row;
+            matrix_changed |= ((matrix_row_bits_t)1<<i);
+        }
+#endif
+        unselect_row(i);
+    }
+
+#ifndef PER_KEY_DEBOUNCE_ENABLE
+    if (debouncing) {
+        if (--debouncing) {
+            _delay_ms(1);
+        } else {
+            for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+                if (matrix[i] != matrix_debouncing[i]) {
+                    matrix_time[i] = matrix_debouncing_time[i];
+                    matrix_changed |= ((matrix_row_bits_t)1<<i);
+                }
+                matrix[i] = matrix_debouncing[i];
+            }
+        }
+    }
+#endif
+
+    return 1;
+}
+
+bool matrix_is_modified(void)
+{
+#ifndef PER_KEY_DEBOUNCE_ENABLE
+    if (debouncing) return false;
+#endif
+    return true;
+}
+
+inline
+bool matrix_is_on(uint8_t row, uint8_t col)
+{
+    return (matrix[row] & ((matrix_row_t)1<<col));
+}
+
+inline
+matrix_row_t matrix_get_row(uint8_t row)
+{
+    return matrix[row];
+}
+
+inline
+uint16_t matrix_get_row_time(uint8_t row)
+{
+    return matrix_time[row];
+}
+
+inline
+matrix_row_bits_t matrix_changed_rows(void)
+{
+    return matrix_changed;
+}
+
+void matrix_print(void)
+{
+    print("\nr/c 0123456789ABCDEF\n");
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        phex(row); print(": ");
+#if (MATRIX_COLS <= 8)
+        pbin_reverse(matrix_get_row(row));
+#elif (MATRIX_COLS <= 16)
+        pbin_reverse16(matrix_get_row(row));
+#else
+        print_bin_reverse32(matrix_get_row(row));
+#endif
+        print("\n");
+    }
+}
+
+uint8_t matrix_key_count(void)
+{
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+#if (MATRIX_COLS <= 8)
+        count += bitpop(matrix[i]);
+#elif (MATRIX_COLS <= 16)
+        count += bitpop16(matrix[i]);
+#else
+        count += bitpop32(matrix[i]);
+#endif
+    }
+    return count;
+}
+
+/* mask of a column run in its port */
+#define MATRIX_COL_MASK(bit, bits)  ((uint8_t)(((1<<(bits))-1) << (bit)))
+
+static void  init_cols(void)
+{
+    // Input with pull-up(DDR:0, PORT:1)
+#define MATRIX_COL_RUN(port, bit, bits, col) \
+    DDR##port  &= ~MATRIX_COL_MASK(bit, bits); \
+    PORT##port |=  MATRIX_COL_MASK(bit, bits);
+    MATRIX_COL_PINS
+#undef MATRIX_COL_RUN
+}
+
+static matrix_row_t read_cols(void)
+{
+    matrix_row_t cols = 0;
+    // latch each port once, low pin is on
+#define MATRIX_COL_PORT(port) \
+    uint8_t pin_##port = ~PIN##port;
+    MATRIX_COL_PORTS
+#undef MATRIX_COL_PORT
+    // mask the run and shift it from its bit to its column
+#define MATRIX_COL_RUN(port, bit, bits, col) \
+    cols |= ((matrix_row_t)(uint8_t)(pin_##port & MATRIX_COL_MASK(bit, bits)) \
+                >> ((bit) > (col) ? (bit) - (col) : 0)) \
+                << ((col) > (bit) ? (col) - (bit) : 0);
+    MATRIX_COL_PINS
+#undef MATRIX_COL_RUN
+    return cols;
+}
+
+static void unselect_rows(void)
+{
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+        unselect_row(i);
+    }
+}
+
+static void unselect_row(uint8_t row)
+{
+    // Hi-Z(DDR:0, PORT:0) to unselect
+    *row_pins[row].ddr  &= ~row_pins[row].mask;
+    *row_pins[row].port &= ~row_pins[row].mask;
+}
+
+static void select_row(uint8_t row)
+{
+    // Output low(DDR:1, PORT:0) to select
+    *row_pins[row].ddr  |=  row_pins[row].mask;
+    *row_pins[row].port &= ~row_pins[row].mask;
+}
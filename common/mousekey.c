@@ -20,6 +20,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "keycode.h"
 #include "host.h"
 #include "timer.h"
+#include "deadline.h"
 #include "print.h"
 #include "debug.h"
 #include "mousekey.h"
@@ -100,8 +101,10 @@ void mousekey_task(void)
     if (timer_elapsed(last_timer) < (mousekey_repeat ? mk_interval : mk_delay*10))
         return;
 
-    if (mouse_report.x == 0 && mouse_report.y == 0 && mouse_report.v == 0 && mouse_report.h == 0)
+    if (mouse_report.x == 0 && mouse_report.y == 0 && mouse_report.v == 0 && mouse_report.h == 0) {
+        deadline_clear(DEADLINE_MOUSEKEY);
         return;
+    }
 
     if (mousekey_repeat != UINT8_MAX)
         mousekey_repeat++;
@@ -174,6 +177,7 @@ void mousekey_send(void)
     mousekey_debug();
     host_mouse_send(&mouse_report);
     last_timer = timer_read();
+    deadline_set(DEADLINE_MOUSEKEY, last_timer + (mousekey_repeat ? mk_interval : mk_delay*10));
 }
 
 void mousekey_clear(void)
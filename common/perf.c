@@ -0,0 +1,81 @@
+/*
+ * Scan loop time statistics
+ */
+#include <stdint.h>
+#include <avr/pgmspace.h>
+#include "timer.h"
+#include "print.h"
+#include "perf.h"
+
+
+typedef struct {
+    uint16_t min;
+    uint16_t max;
+    uint32_t total;
+    uint32_t count;
+    uint16_t hist[PERF_BINS];
+} perf_stat_t;
+
+static perf_stat_t perf_stat[PERF_PHASES];
+
+static const char perf_name[PERF_PHASES][10] PROGMEM = {
+    "matrix",
+    "action",
+    "mousekey",
+    "ps2_mouse",
+    "host_send",
+    "board",
+    "usb_host",
+};
+
+
+void perf_record(uint8_t phase, uint16_t start)
+{
+    uint16_t ticks = timer_read_ticks() - start;
+    perf_stat_t *stat = &perf_stat[phase];
+
+    if (stat->count == 0 || ticks < stat->min) stat->min = ticks;
+    if (ticks > stat->max) stat->max = ticks;
+    stat->total += ticks;
+    stat->count++;
+
+    uint8_t bin = 0;
+    for (uint16_t t = ticks; t && bin < PERF_BINS - 1; t >>= 1) bin++;
+    if (stat->hist[bin] != UINT16_MAX) stat->hist[bin]++;
+}
+
+void perf_clear(void)
+{
+    for (uint8_t i = 0; i < PERF_PHASES; i++) {
+        perf_stat[i] = (perf_stat_t){};
+    }
+}
+
+/* ticks to microseconds */
+static uint32_t ticks_us(uint32_t ticks)
+{
+    return (ticks * TIMER_RAW_US_X256) >> 8;
+}
+
+void perf_print(void)
+{
+    print("\n\n----- Perf(us) -----\n");
+    print("phase     count      min  mean   max  hist(ticks 0,1,2-3,4-7,..)\n");
+    for (uint8_t i = 0; i < PERF_PHASES; i++) {
+        perf_stat_t *stat = &perf_stat[i];
+        if (stat->count == 0) continue;
+
+        print_P(perf_name[i]);
+        xprintf("\t%10lu %5lu %5lu %5lu ",
+                stat->count,
+                ticks_us(stat->min),
+                ticks_us(stat->total / stat->count),
+                ticks_us(stat->max));
+        for (uint8_t b = 0; b < PERF_BINS; b++) {
+            xprintf(" %u", stat->hist[b]);
+        }
+        print("\n");
+    }
+    xprintf("tick: %u.%02uus\n", (uint16_t)(TIMER_RAW_US_X256 >> 8),
+            (uint16_t)((TIMER_RAW_US_X256 & 0xFF) * 100 >> 8));
+}
@@ -0,0 +1,54 @@
+/*
+ * Scan loop time statistics
+ *
+ * PERF_MEASURE(phase, statement) runs the statement and records its time
+ * in Timer0 ticks: min/max/mean and log2 histogram per phase.
+ * Without PERF_ENABLE it is just the statement.
+ */
+#ifndef PERF_H
+#define PERF_H
+
+#include <stdint.h>
+#include "timer.h"
+
+
+/* phases of scan loop */
+enum perf_phase {
+    PERF_MATRIX_SCAN,
+    PERF_ACTION_EXEC,
+    PERF_MOUSEKEY_TASK,
+    PERF_PS2_MOUSE_TASK,
+    PERF_HOST_SEND,
+    PERF_BOARD_TASK,    /* board hooks like LED or display update */
+    PERF_USB_HOST_TASK, /* USB host of converter */
+    PERF_PHASES
+};
+
+/* histogram bin n counts times of bit length n: 0, 1, 2-3, 4-7, ... */
+#define PERF_BINS   12
+
+
+#ifdef PERF_ENABLE
+#   define PERF_MEASURE(phase, ...) do { \
+        uint16_t perf_start = timer_read_ticks(); \
+        __VA_ARGS__; \
+        perf_record(phase, perf_start); \
+    } while (0)
+#else
+#   define PERF_MEASURE(phase, ...) do { __VA_ARGS__; } while (0)
+#endif
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void perf_record(uint8_t phase, uint16_t start);
+void perf_clear(void);
+void perf_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
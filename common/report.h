@@ -71,22 +71,27 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define SYSTEM_WAKE_UP          0x0083
 
 
-/* key report size(NKRO or boot mode) */
+/* key report size(NKRO or boot mode)
+ * KEYBOARD_REPORT_KEYS: keys of 6KRO report host sees while NKRO is off
+ */
 #if defined(PROTOCOL_PJRC) && defined(NKRO_ENABLE)
 #   include "usb.h"
 #   define REPORT_SIZE KBD2_SIZE
 #   define REPORT_KEYS (KBD2_SIZE - 2)
 #   define REPORT_BITS (KBD2_SIZE - 1)
+#   define KEYBOARD_REPORT_KEYS KBD_REPORT_KEYS
 
 #elif defined(PROTOCOL_LUFA) && defined(NKRO_ENABLE)
 #   include "protocol/lufa/descriptor.h"
 #   define REPORT_SIZE NKRO_EPSIZE
 #   define REPORT_KEYS (NKRO_EPSIZE - 2)
 #   define REPORT_BITS (NKRO_EPSIZE - 1)
+#   define KEYBOARD_REPORT_KEYS (KEYBOARD_EPSIZE - 2)
 
 #else
 #   define REPORT_SIZE 8
 #   define REPORT_KEYS 6
+#   define KEYBOARD_REPORT_KEYS REPORT_KEYS
 #endif
 
 
@@ -57,17 +57,24 @@ void timer_clear(void)
     SREG = sreg;
 }
 
+/* Reads without disabling interrupts. ISR increments timer_count and
+ * always changes its low byte, so a read is retried while the low byte
+ * differs after it; interrupts in the middle of the read are seen this way.
+ * Low byte is at the first address(little endian of avr-gcc).
+ */
+#define TIMER_COUNT_LOW     (*(volatile uint8_t *)&timer_count)
+#define TIMER_COUNT_16      (*(volatile uint16_t *)&timer_count)
+
 inline
 uint16_t timer_read(void)
 {
-    uint32_t t;
+    uint16_t t;
 
-    uint8_t sreg = SREG;
-    cli();
-    t = timer_count;
-    SREG = sreg;
+    do {
+        t = TIMER_COUNT_16;
+    } while ((uint8_t)t != TIMER_COUNT_LOW);
 
-    return (t & 0xFFFF);
+    return t;
 }
 
 inline
@@ -75,10 +82,9 @@ uint32_t timer_read32(void)
 {
     uint32_t t;
 
-    uint8_t sreg = SREG;
-    cli();
-    t = timer_count;
-    SREG = sreg;
+    do {
+        t = timer_count;
+    } while ((uint8_t)t != TIMER_COUNT_LOW);
 
     return t;
 }
@@ -86,27 +92,59 @@ uint32_t timer_read32(void)
 inline
 uint16_t timer_elapsed(uint16_t last)
 {
-    uint32_t t;
+    uint16_t t = timer_read();
 
-    uint8_t sreg = SREG;
-    cli();
-    t = timer_count;
-    SREG = sreg;
-
-    return TIMER_DIFF_16((t & 0xFFFF), last);
+    return TIMER_DIFF_16(t, last);
 }
 
 inline
 uint32_t timer_elapsed32(uint32_t last)
+{
+    uint32_t t = timer_read32();
+
+    return TIMER_DIFF_32(t, last);
+}
+
+/* timer_count and Timer0 count register of the same moment.
+ * Retried while ISR runs in the middle as timer_read() does.
+ */
+static inline uint32_t timer_read_raw(uint8_t *raw)
 {
     uint32_t t;
+    uint8_t r;
+    uint8_t pending;
+
+    do {
+        t = timer_count;
+        r = TIMER_RAW;
+        // compare match is pending: counter register has already wrapped
+        pending = ((TIFR0 & (1<<OCF0A)) && r < TIMER_RAW_TOP/2);
+    } while ((uint8_t)t != TIMER_COUNT_LOW);
+
+    *raw = r;
+    return t + pending;
+}
 
-    uint8_t sreg = SREG;
-    cli();
-    t = timer_count;
-    SREG = sreg;
+/* Microsecond resolution from Timer0 count register.
+ * Wraps around after about 71 minutes.
+ */
+uint32_t timer_read_us(void)
+{
+    uint8_t raw;
+    uint32_t t = timer_read_raw(&raw);
 
-    return TIMER_DIFF_32(t, last);
+    return t * 1000 + (((uint32_t)raw * TIMER_RAW_US_X256) >> 8);
+}
+
+/* Timer0 raw count extended with 1ms count, for short time measurement.
+ * (TIMER_RAW_TOP+1) ticks per 1ms, wraps around in 16bit.
+ */
+uint16_t timer_read_ticks(void)
+{
+    uint8_t raw;
+    uint16_t t = timer_read_raw(&raw);
+
+    return t * (TIMER_RAW_TOP + 1) + raw;
 }
 
 // excecuted once per 1ms.(excess for just timer count?)
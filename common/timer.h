@@ -34,6 +34,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define TIMER_RAW_FREQ      (F_CPU/TIMER_PRESCALER)
 #define TIMER_RAW           TCNT0
 #define TIMER_RAW_TOP       (TIMER_RAW_FREQ/1000)
+/* microseconds per raw count in 8.8 fixed point */
+#define TIMER_RAW_US_X256   (1000000UL*256/TIMER_RAW_FREQ)
 
 #if (TIMER_RAW_TOP > 255)
 #   error "Timer0 can't count 1ms at this clock freq. Use larger prescaler."
@@ -55,10 +57,14 @@ extern volatile uint32_t timer_count;
 
 void timer_init(void);
 void timer_clear(void);
+/* reads don't disable interrupts, safe from ISR as well */
 uint16_t timer_read(void);
 uint32_t timer_read32(void);
 uint16_t timer_elapsed(uint16_t last);
 uint32_t timer_elapsed32(uint32_t last);
+/* microseconds and Timer0 ticks, timer_count combined with TCNT0 */
+uint32_t timer_read_us(void);
+uint16_t timer_read_ticks(void);
 
 #ifdef __cplusplus
 }
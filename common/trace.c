@@ -0,0 +1,81 @@
+/*
+ * Key event latency trace
+ */
+#include <stdint.h>
+#include <avr/pgmspace.h>
+#include "timer.h"
+#include "print.h"
+#include "trace.h"
+
+
+typedef struct {
+    uint8_t  id;
+    uint8_t  stage;
+    uint16_t ticks;
+} trace_entry_t;
+
+/* ring of the latest entries */
+static trace_entry_t trace_ring[TRACE_SIZE];
+static uint8_t trace_head = 0;
+static uint8_t trace_len = 0;
+static uint8_t trace_last_id = 0;
+
+uint8_t trace_id = 0;
+
+static const char trace_stage_name[TRACE_STAGES][9] PROGMEM = {
+    "sample",
+    "settle",
+    "action",
+    "report",
+    "endpoint",
+};
+
+
+uint8_t trace_new_id(void)
+{
+    if (++trace_last_id == 0) trace_last_id = 1;
+    return trace_last_id;
+}
+
+void trace_record(uint8_t id, uint8_t stage, uint16_t ticks)
+{
+    if (id == 0) return;
+
+    trace_ring[trace_head] = (trace_entry_t){ .id = id, .stage = stage, .ticks = ticks };
+    trace_head = (trace_head + 1) % TRACE_SIZE;
+    if (trace_len < TRACE_SIZE) trace_len++;
+}
+
+void trace_clear(void)
+{
+    trace_head = 0;
+    trace_len = 0;
+}
+
+/* entry of ring in order of record */
+static trace_entry_t *trace_entry(uint8_t i)
+{
+    return &trace_ring[(trace_head + TRACE_SIZE - trace_len + i) % TRACE_SIZE];
+}
+
+void trace_print(void)
+{
+    print("\n\n----- Trace -----\n");
+    print("id stage      us(from first stage of id)\n");
+    for (uint8_t i = 0; i < trace_len; i++) {
+        trace_entry_t *e = trace_entry(i);
+
+        // first entry of the id still in the ring
+        uint16_t first = e->ticks;
+        for (uint8_t j = 0; j < i; j++) {
+            if (trace_entry(j)->id == e->id) {
+                first = trace_entry(j)->ticks;
+                break;
+            }
+        }
+
+        xprintf("%02X ", e->id);
+        print_P(trace_stage_name[e->stage]);
+        xprintf("\t%lu\n", ((uint32_t)(uint16_t)(e->ticks - first) * TIMER_RAW_US_X256) >> 8);
+    }
+}
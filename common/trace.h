@@ -0,0 +1,54 @@
+/*
+ * Key event latency trace
+ *
+ * Each key event gets an id when keyboard_task() finds it. Stages of the
+ * event are stamped with Timer0 ticks(timer_read_ticks()) into a ring in
+ * RAM, from matrix sample to the report packet handed to USB endpoint.
+ * Without TRACE_ENABLE the macros are empty.
+ */
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include "timer.h"
+
+
+/* stages of key event */
+enum trace_stage {
+    TRACE_SAMPLE,       /* switch sampled in new state, 1ms resolution */
+    TRACE_SETTLE,       /* debounced change found by keyboard_task() */
+    TRACE_ACTION,       /* tapping decided, action is processed */
+    TRACE_REPORT,       /* send_keyboard_report() */
+    TRACE_ENDPOINT,     /* report handed to USB endpoint */
+    TRACE_STAGES
+};
+
+#ifndef TRACE_SIZE
+#   define TRACE_SIZE   64
+#endif
+
+
+#ifdef TRACE_ENABLE
+#   define TRACE_STAMP(id, stage)   trace_record(id, stage, timer_read_ticks())
+#else
+#   define TRACE_STAMP(id, stage)
+#endif
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* id of the event being processed, 0 if none */
+extern uint8_t trace_id;
+
+uint8_t trace_new_id(void);
+void trace_record(uint8_t id, uint8_t stage, uint16_t ticks);
+void trace_clear(void);
+void trace_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -78,6 +78,38 @@ uint8_t biton32(uint32_t bits)
     return n;
 }
 
+// find first set - return lowest location of on-bit
+// NOTE: result is meaningless when all bits are off
+uint8_t bitffs(uint8_t bits)
+{
+    uint8_t n = 0;
+    if (!(bits & 0x0F)) { bits >>= 4; n += 4;}
+    if (!(bits & 0x03)) { bits >>= 2; n += 2;}
+    if (!(bits & 0x01)) { n += 1;}
+    return n;
+}
+
+uint8_t bitffs16(uint16_t bits)
+{
+    uint8_t n = 0;
+    if (!(bits & 0x00FF)) { bits >>= 8; n += 8;}
+    if (!(bits & 0x000F)) { bits >>= 4; n += 4;}
+    if (!(bits & 0x0003)) { bits >>= 2; n += 2;}
+    if (!(bits & 0x0001)) { n += 1;}
+    return n;
+}
+
+uint8_t bitffs32(uint32_t bits)
+{
+    uint8_t n = 0;
+    if (!(bits & 0x0000FFFF)) { bits >>=16; n +=16;}
+    if (!(bits & 0x000000FF)) { bits >>= 8; n += 8;}
+    if (!(bits & 0x0000000F)) { bits >>= 4; n += 4;}
+    if (!(bits & 0x00000003)) { bits >>= 2; n += 2;}
+    if (!(bits & 0x00000001)) { n += 1;}
+    return n;
+}
+
 
 
 uint8_t bitrev(uint8_t bits)
@@ -36,6 +36,10 @@ uint8_t biton(uint8_t bits);
 uint8_t biton16(uint16_t bits);
 uint8_t biton32(uint32_t bits);
 
+uint8_t bitffs(uint8_t bits);
+uint8_t bitffs16(uint16_t bits);
+uint8_t bitffs32(uint32_t bits);
+
 uint8_t  bitrev(uint8_t bits);
 uint16_t bitrev16(uint16_t bits);
 uint32_t bitrev32(uint32_t bits);
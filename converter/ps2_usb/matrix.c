@@ -69,6 +69,8 @@ static uint8_t matrix[MATRIX_ROWS];
 #define PAUSE          (0xFE)
 
 static bool is_modified = false;
+/* rows changed in the last scan */
+static matrix_row_bits_t changed_rows = 0;
 
 
 inline
@@ -182,6 +184,7 @@ uint8_t matrix_scan(void)
 
 
     is_modified = false;
+    changed_rows = 0;
 
     // 'pseudo break code' hack
     if (matrix_is_on(ROW(PAUSE), COL(PAUSE))) {
@@ -396,6 +399,11 @@ bool matrix_is_modified(void)
     return is_modified;
 }
 
+matrix_row_bits_t matrix_changed_rows(void)
+{
+    return changed_rows;
+}
+
 inline
 bool matrix_has_ghost(void)
 {
@@ -467,6 +475,7 @@ static void matrix_make(uint8_t code)
 {
     if (!matrix_is_on(ROW(code), COL(code))) {
         matrix[ROW(code)] |= 1<<COL(code);
+        changed_rows |= (matrix_row_bits_t)1<<ROW(code);
         is_modified = true;
     }
 }
@@ -476,6 +485,7 @@ static void matrix_break(uint8_t code)
 {
     if (matrix_is_on(ROW(code), COL(code))) {
         matrix[ROW(code)] &= ~(1<<COL(code));
+        changed_rows |= (matrix_row_bits_t)1<<ROW(code);
         is_modified = true;
     }
 }
@@ -484,4 +494,5 @@ inline
 static void matrix_clear(void)
 {
     for (uint8_t i=0; i < MATRIX_ROWS; i++) matrix[i] = 0x00;
+    changed_rows = ~(matrix_row_bits_t)0;
 }
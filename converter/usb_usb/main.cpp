@@ -15,6 +15,7 @@
 #include "timer.h"
 #include "debug.h"
 #include "keyboard.h"
+#include "perf.h"
 
 #include "leonardo_led.h"
 
@@ -83,19 +84,13 @@ uint8_t ret;
     
     debug("init: done\n");
 
-uint16_t timer;
 // to see loop pulse with oscillo scope
 DDRF = (1<<7);
     for (;;) {
 PORTF ^= (1<<7);
         keyboard_task();
 
-timer = timer_read();
-        usb_host.Task();
-timer = timer_elapsed(timer);
-if (timer > 100) {
-    debug("host.Task: "); debug_hex16(timer);  debug("\n");
-}
+        PERF_MEASURE(PERF_USB_HOST_TASK, usb_host.Task());
 
 #if !defined(INTERRUPT_CONTROL_ENDPOINT)
         // LUFA Task for control request
@@ -55,19 +55,46 @@ void matrix_init(void) {}
 bool matrix_has_ghost(void) { return false; }
 
 static bool matrix_is_mod =false;
+static matrix_row_bits_t matrix_changed = 0;
+
+/* rows which have keys of the report */
+static matrix_row_bits_t report_rows(report_keyboard_t *report) {
+    matrix_row_bits_t rows = 0;
+
+    if (report->mods) {
+        rows |= (matrix_row_bits_t)1<<ROW(KC_LCTRL);
+    }
+    for (uint8_t i = 0; i < REPORT_KEYS; i++) {
+        if (IS_ANY(report->keys[i])) {
+            rows |= (matrix_row_bits_t)1<<ROW(report->keys[i]);
+        }
+    }
+    return rows;
+}
 
 uint8_t matrix_scan(void) {
     static uint16_t last_time_stamp = 0;
+    static matrix_row_bits_t last_rows = 0;
 
     if (last_time_stamp != usb_hid_time_stamp) {
         last_time_stamp = usb_hid_time_stamp;
         matrix_is_mod = true;
+
+        // keys can change only on rows of previous and new report
+        matrix_row_bits_t rows = report_rows(&usb_hid_keyboard_report);
+        matrix_changed = rows | last_rows;
+        last_rows = rows;
     } else {
         matrix_is_mod = false;
+        matrix_changed = 0;
     }
     return 1;
 }
 
+matrix_row_bits_t matrix_changed_rows(void) {
+    return matrix_changed;
+}
+
 bool matrix_is_modified(void) {
 
     return matrix_is_mod;
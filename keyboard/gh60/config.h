@@ -31,11 +31,51 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define MATRIX_ROWS 5
 #define MATRIX_COLS 14
 
+/* Row pin configuration
+ * row: 0   1   2   3   4
+ * pin: D0  D1  D2  D3  D5
+ */
+#define MATRIX_ROW_PINS \
+    MATRIX_ROW_PIN(D, 0), MATRIX_ROW_PIN(D, 1), MATRIX_ROW_PIN(D, 2), \
+    MATRIX_ROW_PIN(D, 3), MATRIX_ROW_PIN(D, 5)
+
+/* Column pin configuration
+ * col: 0   1   2   3   4   5   6   7   8   9   10  11  12  13
+ * pin: F0  F1  E6  C7  C6  B6  D4  B1  B0  B5  B4  D7  D6  B3  (Rev.A)
+ * pin:                                 B7                      (Rev.B)
+ */
+#define MATRIX_COL_PORTS \
+    MATRIX_COL_PORT(B) MATRIX_COL_PORT(C) MATRIX_COL_PORT(D) \
+    MATRIX_COL_PORT(E) MATRIX_COL_PORT(F)
+#define MATRIX_COL_PINS \
+    MATRIX_COL_RUN(F, 0, 2, 0) \
+    MATRIX_COL_RUN(E, 6, 1, 2) \
+    MATRIX_COL_RUN(C, 7, 1, 3) \
+    MATRIX_COL_RUN(C, 6, 1, 4) \
+    MATRIX_COL_RUN(B, 6, 1, 5) \
+    MATRIX_COL_RUN(D, 4, 1, 6) \
+    MATRIX_COL_RUN(B, 1, 1, 7) \
+    MATRIX_COL_RUN(B, 0, 1, 8) \
+    MATRIX_COL_RUN(B, 7, 1, 8) \
+    MATRIX_COL_RUN(B, 5, 1, 9) \
+    MATRIX_COL_RUN(B, 4, 1, 10) \
+    MATRIX_COL_RUN(D, 7, 1, 11) \
+    MATRIX_COL_RUN(D, 6, 1, 12) \
+    MATRIX_COL_RUN(B, 3, 1, 13)
+
 /* define if matrix has ghost */
 //#define MATRIX_HAS_GHOST
 
 /* Set 0 if debouncing isn't needed */
 #define DEBOUNCE    5
+/* with PER_KEY_DEBOUNCE_ENABLE: send press on first sample, defer only release */
+//#define DEBOUNCE_EAGER_PRESS
+
+/* cache action of each key until layer change(RAM: 2 bytes per key) */
+//#define ACTION_CACHE_ENABLE
+
+/* with KEYMAP_BLOB_ENABLE: lowest layers of keymap blob to keep in RAM */
+//#define KEYMAP_BLOB_RAM_LAYERS 2
 
 /* Mechanical locking support. Use KC_LCAP, KC_LNUM or KC_LSCR instead in keymap */
 #define LOCKING_SUPPORT_ENABLE
@@ -60,6 +100,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 /* disable print */
 //#define NO_PRINT
 
+/* settle tap key as hold when other key is typed while holding it */
+//#define PERMISSIVE_HOLD
+
 /* disable action features */
 //#define NO_ACTION_LAYER
 //#define NO_ACTION_TAPPING
@@ -0,0 +1,44 @@
+#include "keymap_common.h"
+#include "action_combo.h"
+
+/*
+ * Combo: plain ANSI layout with chords on home row, build with COMBO_ENABLE
+ */
+const uint8_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
+    /* Keymap 0: Default Layer
+     * ,-----------------------------------------------------------.
+     * |Esc|  1|  2|  3|  4|  5|  6|  7|  8|  9|  0|  -|  =|Backsp |
+     * |-----------------------------------------------------------|
+     * |Tab  |  Q|  W|  E|  R|  T|  Y|  U|  I|  O|  P|  [|  ]|    \|
+     * |-----------------------------------------------------------|
+     * |Caps  |  A|  S|  D|  F|  G|  H|  J|  K|  L|  ;|  '|Return  |
+     * |-----------------------------------------------------------|
+     * |Shift   |  Z|  X|  C|  V|  B|  N|  M|  ,|  .|  /|Shift     |
+     * |-----------------------------------------------------------|
+     * |Ctrl|Gui |Alt |      Space             |Alt |Gui |App |Ctrl|
+     * `-----------------------------------------------------------'
+     */
+    KEYMAP_ANSI(
+        ESC, 1,   2,   3,   4,   5,   6,   7,   8,   9,   0,   MINS,EQL, BSPC, \
+        TAB, Q,   W,   E,   R,   T,   Y,   U,   I,   O,   P,   LBRC,RBRC,BSLS, \
+        CAPS,A,   S,   D,   F,   G,   H,   J,   K,   L,   SCLN,QUOT,     ENT,  \
+        LSFT,Z,   X,   C,   V,   B,   N,   M,   COMM,DOT, SLSH,          RSFT, \
+        LCTL,LGUI,LALT,          SPC,                     RALT,RGUI,APP, RCTL),
+};
+
+/*
+ * Fn action definition
+ */
+const uint16_t PROGMEM fn_actions[] = {
+};
+
+/*
+ * Combos: keys pressed within COMBO_TERM
+ * J+K = Esc, D+F = Backspace, S+D+F = Delete
+ */
+const combo_t PROGMEM combos[] = {
+    COMBO(ACTION_KEY(KC_ESC),  COMBO_KEY(2, 7), COMBO_KEY(2, 8)),
+    COMBO(ACTION_KEY(KC_BSPC), COMBO_KEY(2, 3), COMBO_KEY(2, 4)),
+    COMBO(ACTION_KEY(KC_DEL),  COMBO_KEY(2, 2), COMBO_KEY(2, 3), COMBO_KEY(2, 4)),
+};
+const uint8_t combo_count = sizeof(combos) / sizeof(combos[0]);
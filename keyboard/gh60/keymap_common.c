@@ -15,16 +15,27 @@ You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include "keymap_common.h"
+#ifdef KEYMAP_BLOB_ENABLE
+#   include "keymap_blob.h"
+#endif
 
 
+#ifndef SPARSE_KEYMAP_ENABLE
 /* translates key to keycode */
 uint8_t keymap_key_to_keycode(uint8_t layer, key_t key)
 {
+#ifdef KEYMAP_BLOB_ENABLE
+    if (keymap_blob_valid()) return keymap_blob_key_to_keycode(layer, key);
+#endif
     return pgm_read_byte(&keymaps[(layer)][(key.row)][(key.col)]);
 }
+#endif
 
 /* translates Fn keycode to action */
 action_t keymap_fn_to_action(uint8_t keycode)
 {
+#ifdef KEYMAP_BLOB_ENABLE
+    if (keymap_blob_valid()) return keymap_blob_fn_to_action(keycode);
+#endif
     return (action_t){ .code = pgm_read_word(&fn_actions[FN_INDEX(keycode)]) };
 }
@@ -0,0 +1,63 @@
+#include "keymap_common.h"
+#include "action_leader.h"
+
+/*
+ * Leader: plain ANSI layout with Caps Lock as leader key, build with LEADER_ENABLE
+ */
+const uint8_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
+    /* Keymap 0: Default Layer
+     * ,-----------------------------------------------------------.
+     * |Esc|  1|  2|  3|  4|  5|  6|  7|  8|  9|  0|  -|  =|Backsp |
+     * |-----------------------------------------------------------|
+     * |Tab  |  Q|  W|  E|  R|  T|  Y|  U|  I|  O|  P|  [|  ]|    \|
+     * |-----------------------------------------------------------|
+     * |Leader|  A|  S|  D|  F|  G|  H|  J|  K|  L|  ;|  '|Return  |
+     * |-----------------------------------------------------------|
+     * |Shift   |  Z|  X|  C|  V|  B|  N|  M|  ,|  .|  /|Shift     |
+     * |-----------------------------------------------------------|
+     * |Ctrl|Gui |Alt |      Space             |Alt |Gui |App |Ctrl|
+     * `-----------------------------------------------------------'
+     */
+    KEYMAP_ANSI(
+        ESC, 1,   2,   3,   4,   5,   6,   7,   8,   9,   0,   MINS,EQL, BSPC, \
+        TAB, Q,   W,   E,   R,   T,   Y,   U,   I,   O,   P,   LBRC,RBRC,BSLS, \
+        FN0, A,   S,   D,   F,   G,   H,   J,   K,   L,   SCLN,QUOT,     ENT,  \
+        LSFT,Z,   X,   C,   V,   B,   N,   M,   COMM,DOT, SLSH,          RSFT, \
+        LCTL,LGUI,LALT,          SPC,                     RALT,RGUI,APP, RCTL),
+};
+
+/*
+ * Fn action definition
+ */
+const uint16_t PROGMEM fn_actions[] = {
+    [0] = ACTION_LEADER(),
+};
+
+/*
+ * Macro definition
+ */
+enum macro_id {
+    HELLO,
+};
+
+const macro_t *action_get_macro(keyrecord_t *record, uint8_t id, uint8_t opt)
+{
+    switch (id) {
+        case HELLO:
+            return (record->event.pressed ?
+                    MACRO( TEXT('H', 'e', 'l', 'l', 'o', '!'), END ) :
+                    MACRO_NONE);
+    }
+    return MACRO_NONE;
+}
+
+/*
+ * Leader sequences: keys typed after leader key
+ * H,I = Hello!, E = Esc, E,D = Delete, C,A,D = Ctrl+Alt+Delete
+ */
+const leader_seq_t PROGMEM leader_sequences[] = {
+    LEADER_SEQ(ACTION_MACRO(HELLO), KC_H, KC_I),
+    LEADER_SEQ(ACTION_KEY(KC_ESC), KC_E),
+    LEADER_SEQ(ACTION_KEY(KC_DEL), KC_E, KC_D),
+    LEADER_SEQ(ACTION_MODS_KEY(MOD_LCTL | MOD_LALT, KC_DEL), KC_C, KC_A, KC_D),
+};
@@ -36,6 +36,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define MATRIX_ROWS 5
 #define MATRIX_COLS 19
 #define DEBOUNCE    5
+// With PER_KEY_DEBOUNCE_ENABLE send press on first sample, defer only release.
+//#define DEBOUNCE_EAGER_PRESS
 
 // Mechanical locking support.
 // Use KC_LCAP, KC_LNUM or KC_LSCR instead in keymap.
@@ -29,7 +29,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "led-local.h"
 #include "print.h"
 #include "matrix.h"
+#include "timer.h"
 #include "util.h"
+#include "perf.h"
+
+#ifdef PER_KEY_DEBOUNCE_ENABLE
+#include "debounce.h"
+#endif
 
 #ifdef DISPLAY_ENABLE
 #include "display.h"
@@ -51,12 +57,21 @@ static void unselect_rows(void);
 #ifndef DEBOUNCE
 #   define DEBOUNCE    5
 #endif
+#ifndef PER_KEY_DEBOUNCE_ENABLE
 static uint8_t debouncing = DEBOUNCE;
+#endif
 
 /* matrix state(1:on, 0:off) */
 static matrix_row_t matrix[MATRIX_ROWS];
 static matrix_row_t matrix_debouncing[MATRIX_ROWS];
 
+/* time(ms) when row started to change */
+static uint16_t matrix_time[MATRIX_ROWS];
+static uint16_t matrix_debouncing_time[MATRIX_ROWS];
+
+/* rows changed in the last scan */
+static matrix_row_bits_t matrix_changed;
+
 
 /***************************************************************************/
 
@@ -88,6 +103,22 @@ matrix_row_t matrix_get_row( uint8_t row ) {
 }
 
 
+/***************************************************************************/
+
+inline
+uint16_t matrix_get_row_time( uint8_t row ) {
+    return matrix_time[row];
+}
+
+
+/***************************************************************************/
+
+inline
+matrix_row_bits_t matrix_changed_rows() {
+    return matrix_changed;
+}
+
+
 /***************************************************************************/
 
 // common/keyboard.c invokes this when the keyboard is initialized.
@@ -107,6 +138,9 @@ void matrix_init() {
         matrix[ i ] = (matrix_row_t) 0;
         matrix_debouncing[ i ] = (matrix_row_t) 0;
     }
+#ifdef PER_KEY_DEBOUNCE_ENABLE
+    debounce_init();
+#endif
 
     // Initialize LED control logic:
     led_init();
@@ -170,7 +204,13 @@ uint8_t matrix_scan() {
 
     // Update LED states if necessary:
 #ifdef LED_CONTROLLER_ENABLE
-    led_update();
+    PERF_MEASURE( PERF_BOARD_TASK, led_update() );
+#endif
+
+    matrix_changed = 0;
+
+#ifdef PER_KEY_DEBOUNCE_ENABLE
+    debounce_tick();
 #endif
 
     for ( uint8_t i = 0; i < MATRIX_ROWS; i++ ) {
@@ -182,8 +222,12 @@ uint8_t matrix_scan() {
 
         if ( matrix_debouncing[ i ] != cols ) {
 
+            if ( matrix_debouncing[ i ] == matrix[ i ] ) {
+                matrix_debouncing_time[ i ] = timer_read();
+            }
             matrix_debouncing[ i ] = cols;
 
+#ifndef PER_KEY_DEBOUNCE_ENABLE
             if ( debouncing ) {
 
                 debug("bounce!: ");
@@ -191,10 +235,22 @@ uint8_t matrix_scan() {
                 debug( "\n" );
             }
             debouncing = DEBOUNCE;
+#endif
+        }
+
+#ifdef PER_KEY_DEBOUNCE_ENABLE
+        matrix_row_t row = debounce_row( i, cols );
+
+        if ( matrix[ i ] != row ) {
+            matrix_time[ i ] = matrix_debouncing_time[ i ];
+            matrix[ i ] = row;
+            matrix_changed |= ( (matrix_row_bits_t) 1<<i );
         }
+#endif
         unselect_rows();
     }
 
+#ifndef PER_KEY_DEBOUNCE_ENABLE
     if ( debouncing ) {
 
         if ( --debouncing ) {
@@ -204,10 +260,16 @@ uint8_t matrix_scan() {
         } else {
 
             for ( uint8_t i = 0; i < MATRIX_ROWS; i++ ) {
+
+                if ( matrix[ i ] != matrix_debouncing[ i ] ) {
+                    matrix_time[ i ] = matrix_debouncing_time[ i ];
+                    matrix_changed |= ( (matrix_row_bits_t) 1<<i );
+                }
                 matrix[ i ] = matrix_debouncing[ i ];
             }
         }
     }
+#endif
 
     return 1;
 }
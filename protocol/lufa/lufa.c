@@ -48,6 +48,7 @@
 #include "sleep_led.h"
 #endif
 #include "suspend.h"
+#include "trace.h"
 
 #include "descriptor.h"
 #include "lufa.h"
@@ -352,9 +353,12 @@ static uint8_t keyboard_leds(void)
 static void send_keyboard(report_keyboard_t *report)
 {
     uint8_t timeout = 0;
+    uint8_t err;
 
-    if (USB_DeviceState != DEVICE_STATE_Configured)
+    if (USB_DeviceState != DEVICE_STATE_Configured) {
+        host_keyboard_dropped();
         return;
+    }
 
     /* Select the Keyboard Report Endpoint */
 #ifdef NKRO_ENABLE
@@ -373,17 +377,20 @@ static void send_keyboard(report_keyboard_t *report)
     /* Write Keyboard Report Data */
 #ifdef NKRO_ENABLE
     if (keyboard_nkro) {
-        Endpoint_Write_Stream_LE(report, NKRO_EPSIZE, NULL);
+        err = Endpoint_Write_Stream_LE(report, NKRO_EPSIZE, NULL);
     }
     else
 #endif
     {
         /* boot mode */
-        Endpoint_Write_Stream_LE(report, KEYBOARD_EPSIZE, NULL);
+        err = Endpoint_Write_Stream_LE(report, KEYBOARD_EPSIZE, NULL);
     }
+    if (err != ENDPOINT_RWSTREAM_NoError)
+        host_keyboard_dropped();
 
     /* Finalize the stream transfer to send the last packet */
     Endpoint_ClearIN();
+    TRACE_STAMP(trace_id, TRACE_ENDPOINT);
 
     keyboard_report_sent = *report;
 }
@@ -393,8 +400,10 @@ static void send_mouse(report_mouse_t *report)
 #ifdef MOUSE_ENABLE
     uint8_t timeout = 0;
 
-    if (USB_DeviceState != DEVICE_STATE_Configured)
+    if (USB_DeviceState != DEVICE_STATE_Configured) {
+        host_mouse_dropped();
         return;
+    }
 
     /* Select the Mouse Report Endpoint */
     Endpoint_SelectEndpoint(MOUSE_IN_EPNUM);
@@ -403,7 +412,8 @@ static void send_mouse(report_mouse_t *report)
     while (--timeout && !Endpoint_IsReadWriteAllowed()) ;
 
     /* Write Mouse Report Data */
-    Endpoint_Write_Stream_LE(report, sizeof(report_mouse_t), NULL);
+    if (Endpoint_Write_Stream_LE(report, sizeof(report_mouse_t), NULL) != ENDPOINT_RWSTREAM_NoError)
+        host_mouse_dropped();
 
     /* Finalize the stream transfer to send the last packet */
     Endpoint_ClearIN();
@@ -24,6 +24,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "debug.h"
 #include "host_driver.h"
 #include "vusb.h"
+#include "trace.h"
 
 
 static uint8_t vusb_keyboard_leds = 0;
@@ -34,6 +35,10 @@ static uint8_t vusb_idle_rate = 0;
 static report_keyboard_t kbuf[KBUF_SIZE];
 static uint8_t kbuf_head = 0;
 static uint8_t kbuf_tail = 0;
+#ifdef TRACE_ENABLE
+/* trace id of key event which made the report */
+static uint8_t kbuf_trace_id[KBUF_SIZE];
+#endif
 
 
 /* transfer keyboard report from buffer */
@@ -42,6 +47,7 @@ void vusb_transfer_keyboard(void)
     if (usbInterruptIsReady()) {
         if (kbuf_head != kbuf_tail) {
             usbSetInterrupt((void *)&kbuf[kbuf_tail], sizeof(report_keyboard_t));
+            TRACE_STAMP(kbuf_trace_id[kbuf_tail], TRACE_ENDPOINT);
             kbuf_tail = (kbuf_tail + 1) % KBUF_SIZE;
             if (debug_keyboard) {
                 print("V-USB: kbuf["); pdec(kbuf_tail); print("->"); pdec(kbuf_head); print("](");
@@ -84,9 +90,13 @@ static void send_keyboard(report_keyboard_t *report)
     uint8_t next = (kbuf_head + 1) % KBUF_SIZE;
     if (next != kbuf_tail) {
         kbuf[kbuf_head] = *report;
+#ifdef TRACE_ENABLE
+        kbuf_trace_id[kbuf_head] = trace_id;
+#endif
         kbuf_head = next;
     } else {
         debug("kbuf: full\n");
+        host_keyboard_dropped();
     }
 
     // NOTE: send key strokes of Macro
@@ -108,6 +118,8 @@ static void send_mouse(report_mouse_t *report)
     };
     if (usbInterruptIsReady3()) {
         usbSetInterrupt3((void *)&r, sizeof(vusb_mouse_report_t));
+    } else {
+        host_mouse_dropped();
     }
 }
 
@@ -0,0 +1,10 @@
+/*
+ * Host build shim of avr-libc <avr/interrupt.h>
+ */
+#ifndef SIM_INTERRUPT_H
+#define SIM_INTERRUPT_H
+
+#define cli()
+#define sei()
+
+#endif
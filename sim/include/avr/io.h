@@ -0,0 +1,9 @@
+/*
+ * Host build shim of avr-libc <avr/io.h>
+ */
+#ifndef SIM_IO_H
+#define SIM_IO_H
+
+#include <stdint.h>
+
+#endif
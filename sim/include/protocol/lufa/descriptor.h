@@ -0,0 +1,11 @@
+/*
+ * Host build shim of protocol/lufa/descriptor.h: endpoint sizes for
+ * report.h of NKRO build
+ */
+#ifndef SIM_DESCRIPTOR_H
+#define SIM_DESCRIPTOR_H
+
+#define KEYBOARD_EPSIZE             8
+#define NKRO_EPSIZE                 16
+
+#endif
@@ -0,0 +1,15 @@
+/*
+ * Host build shim of avr-libc <util/delay.h>
+ * Delays advance the virtual clock instead of spinning.
+ */
+#ifndef SIM_DELAY_H
+#define SIM_DELAY_H
+
+#include <stdint.h>
+
+void sim_delay_us(uint32_t us);
+
+#define _delay_us(us)   sim_delay_us(us)
+#define _delay_ms(ms)   sim_delay_us((uint32_t)(ms) * 1000)
+
+#endif
@@ -0,0 +1,27 @@
+/*
+ * Host simulation of common/ for replaying typing traces
+ */
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "host_driver.h"
+
+
+/* virtual clock(us) which drives timer_* */
+uint32_t sim_time(void);
+void sim_time_set(uint32_t us);
+
+/* virtual matrix which is read by matrix_scan() */
+void sim_matrix_set(uint8_t row, uint8_t col, bool on);
+void sim_matrix_clear(void);
+
+/* recording host driver */
+extern host_driver_t sim_driver;
+void sim_host_clear(void);
+
+/* called by sim_driver on every report sent to host */
+void sim_report(const char *endpoint, const uint8_t *data, uint8_t len);
+
+#endif
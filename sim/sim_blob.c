@@ -0,0 +1,75 @@
+/*
+ * Keymap blob generator: prints Intel HEX of keymap_blob.h format made from
+ * keymaps[] and fn_actions[] of the keymap file included as KEYMAP_C.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include KEYMAP_C
+#include "keymap_blob.h"
+
+
+/* keymap region of ldscript_keymap_avr5.x */
+#define KEYMAP_BLOB_ADDR    0x6800
+
+#define LAYERS      (sizeof(keymaps) / sizeof(keymaps[0]))
+#define FN_COUNT    (sizeof(fn_actions) / sizeof(fn_actions[0]))
+
+static uint8_t blob[KEYMAP_BLOB_SIZE];
+
+static void print_record(uint16_t addr, uint8_t type, const uint8_t *data, uint8_t len)
+{
+    uint8_t sum = len + (addr >> 8) + (addr & 0xFF) + type;
+    printf(":%02X%04X%02X", len, addr, type);
+    for (uint8_t i = 0; i < len; i++) {
+        printf("%02X", data[i]);
+        sum += data[i];
+    }
+    printf("%02X\n", (uint8_t)-sum);
+}
+
+int main(int argc, char **argv)
+{
+    const char *name = (argc > 1 ? argv[1] : KEYMAP_C);
+    uint16_t size = FN_COUNT * 2 + LAYERS * MATRIX_ROWS * MATRIX_COLS;
+
+    if (LAYERS > 32 || FN_COUNT > 32 || sizeof(keymap_blob_header_t) + size > KEYMAP_BLOB_SIZE) {
+        fprintf(stderr, "%s: %u layers and %u fn_actions don't fit in blob\n",
+                name, (unsigned)LAYERS, (unsigned)FN_COUNT);
+        return 1;
+    }
+
+    uint8_t *p = &blob[sizeof(keymap_blob_header_t)];
+    for (uint8_t i = 0; i < FN_COUNT; i++) {
+        *p++ = fn_actions[i] & 0xFF;
+        *p++ = fn_actions[i] >> 8;
+    }
+    for (uint8_t l = 0; l < LAYERS; l++) {
+        for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+            for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+                *p++ = keymaps[l][r][c];
+            }
+        }
+    }
+
+    uint16_t crc = 0xFFFF;
+    for (uint16_t i = 0; i < size; i++) {
+        crc = keymap_blob_crc(crc, blob[sizeof(keymap_blob_header_t) + i]);
+    }
+    uint8_t header[] = {
+        KEYMAP_BLOB_MAGIC & 0xFF, KEYMAP_BLOB_MAGIC >> 8,
+        KEYMAP_BLOB_VERSION, LAYERS, MATRIX_ROWS, MATRIX_COLS, FN_COUNT, 0,
+        size & 0xFF, size >> 8,
+        crc & 0xFF, crc >> 8,
+    };
+    _Static_assert(sizeof(header) == sizeof(keymap_blob_header_t), "header layout");
+    for (uint8_t i = 0; i < sizeof(header); i++) blob[i] = header[i];
+
+    uint16_t len = sizeof(header) + size;
+    for (uint16_t i = 0; i < len; i += 16) {
+        print_record(KEYMAP_BLOB_ADDR + i, 0x00, &blob[i], (len - i < 16 ? len - i : 16));
+    }
+    print_record(0, 0x01, NULL, 0);
+    fprintf(stderr, "%s: %u layers, %u fn_actions: %u bytes at 0x%04X\n",
+            name, (unsigned)LAYERS, (unsigned)FN_COUNT, len, KEYMAP_BLOB_ADDR);
+    return 0;
+}
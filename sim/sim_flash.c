@@ -0,0 +1,14 @@
+/*
+ * Virtual .keymap region of flash: left erased like flash of a firmware
+ * build, replace the section with objcopy to load a keymap blob.
+ *
+ *   objcopy -I ihex -O binary keymap_<name>_blob.hex blob.bin
+ *   objcopy --update-section .keymap=blob.bin sim_<keyboard>_<keymap>_blob
+ */
+#include <stdint.h>
+#include "keymap_blob.h"
+
+
+const uint8_t __keymap_start[KEYMAP_BLOB_SIZE] __attribute__ ((section (".keymap"))) = {
+    [0 ... KEYMAP_BLOB_SIZE - 1] = 0xFF
+};
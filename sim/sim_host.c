@@ -0,0 +1,69 @@
+/*
+ * Recording host driver: hands every report to the simulator.
+ */
+#include <stdint.h>
+#include "report.h"
+#include "host.h"
+#include "led.h"
+#include "sim.h"
+
+
+static uint8_t keyboard_leds(void);
+static void send_keyboard(report_keyboard_t *report);
+static void send_mouse(report_mouse_t *report);
+static void send_system(uint16_t data);
+static void send_consumer(uint16_t data);
+
+host_driver_t sim_driver = {
+    keyboard_leds,
+    send_keyboard,
+    send_mouse,
+    send_system,
+    send_consumer
+};
+
+static uint8_t leds = 0;
+
+
+void sim_host_clear(void)
+{
+    leds = 0;
+}
+
+static uint8_t keyboard_leds(void)
+{
+    return leds;
+}
+
+static void send_keyboard(report_keyboard_t *report)
+{
+#ifdef NKRO_ENABLE
+    // 6KRO report goes in short form to its endpoint, as LUFA sends it
+    if (!keyboard_nkro) {
+        sim_report("keyboard", report->raw, KEYBOARD_REPORT_KEYS + 2);
+        return;
+    }
+#endif
+    sim_report("keyboard", report->raw, sizeof(report_keyboard_t));
+}
+
+static void send_mouse(report_mouse_t *report)
+{
+    sim_report("mouse", (uint8_t *)report, sizeof(report_mouse_t));
+}
+
+static void send_system(uint16_t data)
+{
+    sim_report("system", (uint8_t *)&data, sizeof(data));
+}
+
+static void send_consumer(uint16_t data)
+{
+    sim_report("consumer", (uint8_t *)&data, sizeof(data));
+}
+
+
+/* keyboard LEDs are not simulated */
+void led_set(uint8_t usb_led)
+{
+}
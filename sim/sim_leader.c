@@ -0,0 +1,84 @@
+/*
+ * Leader trie generator: prints leader_trie[] of action_leader.h made from
+ * leader_sequences[] of the keymap file included as KEYMAP_C.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include KEYMAP_C
+#include "action_leader.h"
+
+
+#define SEQUENCES   (sizeof(leader_sequences) / sizeof(leader_sequences[0]))
+#define NODES_MAX   (SEQUENCES * LEADER_LENGTH + 1)
+
+typedef struct {
+    uint16_t action;
+    uint8_t  count;
+    uint8_t  codes[256];        /* sorted */
+    uint16_t children[256];
+    uint16_t index;             /* in leader_trie[] */
+} node_t;
+
+static node_t nodes[NODES_MAX];
+static uint16_t node_count = 1;
+
+static uint16_t child(uint16_t n, uint8_t code)
+{
+    node_t *node = &nodes[n];
+    uint8_t i = 0;
+    while (i < node->count && node->codes[i] < code) i++;
+    if (i < node->count && node->codes[i] == code) return node->children[i];
+
+    for (uint8_t j = node->count; j > i; j--) {
+        node->codes[j] = node->codes[j - 1];
+        node->children[j] = node->children[j - 1];
+    }
+    node->codes[i] = code;
+    node->children[i] = node_count;
+    node->count++;
+    return node_count++;
+}
+
+int main(int argc, char **argv)
+{
+    const char *name = (argc > 1 ? argv[1] : KEYMAP_C);
+
+    for (uint16_t s = 0; s < SEQUENCES; s++) {
+        uint16_t n = 0;
+        for (uint8_t i = 0; i < LEADER_LENGTH && leader_sequences[s].keys[i]; i++) {
+            n = child(n, leader_sequences[s].keys[i]);
+        }
+        if (n == 0 || nodes[n].action != ACTION_NO) {
+            fprintf(stderr, "%s: sequence %u is empty or defined twice\n", name, s);
+            return 1;
+        }
+        nodes[n].action = leader_sequences[s].action;
+    }
+
+    // nodes are laid out in order of creation, parent before its children
+    unsigned words = 0;
+    for (uint16_t n = 0; n < node_count; n++) {
+        nodes[n].index = words;
+        words += LEADER_NODE_CHILD + nodes[n].count * 2;
+    }
+    if (words > 0xFFFF) {
+        fprintf(stderr, "%s: trie too large\n", name);
+        return 1;
+    }
+
+    printf("/*\n");
+    printf(" * Leader trie of %s, generated by sim/sim_leader.c\n", name);
+    printf(" * %u sequences, %u nodes: %u bytes\n", (unsigned)SEQUENCES, node_count, words * 2);
+    printf(" */\n");
+    printf("#include \"action_leader.h\"\n\n");
+    printf("const uint16_t PROGMEM leader_trie[] = {\n");
+    for (uint16_t n = 0; n < node_count; n++) {
+        printf("    /* %u */ 0x%04X, %u,", nodes[n].index, nodes[n].action, nodes[n].count);
+        for (uint8_t i = 0; i < nodes[n].count; i++) {
+            printf(" 0x%02X, %u,", nodes[n].codes[i], nodes[nodes[n].children[i]].index);
+        }
+        printf("\n");
+    }
+    printf("};\n");
+    return 0;
+}
@@ -0,0 +1,337 @@
+/*
+ * Replay timestamped typing traces through common/ and report
+ * processing cost and event-to-report delay.
+ *
+ * Trace format, one event per line:
+ *      <time(ms)> <row> <col> <d|u>
+ * Time can have fraction. Events with the same time land in the same scan.
+ * '#' starts a comment.
+ *
+ * Delay of a key is counted from its edge which is reported at last, an
+ * edge back to the reported state is taken as bounce and dropped.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "keyboard.h"
+#include "action.h"
+#include "action_code.h"
+#include "action_layer.h"
+#include "host.h"
+#include "keycode.h"
+#include "matrix.h"
+#include "report.h"
+#include "timer.h"
+#include "sim.h"
+
+
+#define TRACE_MAX       4096
+/* idle time after the last event so that tapping and oneshot settle */
+#define SETTLE_TIME_US  (1000UL * 1000)
+
+typedef struct {
+    uint32_t time;      /* us */
+    uint8_t  row;
+    uint8_t  col;
+    bool     pressed;
+} trace_event_t;
+
+static trace_event_t trace[TRACE_MAX];
+static uint16_t trace_len = 0;
+
+/* what a report should show to reflect an event */
+typedef struct {
+    enum { EXPECT_NONE, EXPECT_ANY, EXPECT_KEY, EXPECT_MODS, EXPECT_TAP } type;
+    uint8_t code;
+    bool    pressed;
+} expect_t;
+
+/* events waiting for a report */
+typedef struct {
+    uint32_t time;
+    uint8_t  row;
+    uint8_t  col;
+    expect_t expect;
+} pending_t;
+
+static pending_t pending[TRACE_MAX];
+static uint16_t pending_len = 0;
+/* key state last seen in report */
+static bool key_reported[MATRIX_ROWS][MATRIX_COLS];
+/* expectation of press, used for release of the key */
+static expect_t key_expect[MATRIX_ROWS][MATRIX_COLS];
+
+static uint32_t scan_us = 250;
+static bool verbose = false;
+
+static struct {
+    uint32_t events;
+    uint32_t reports;
+    uint32_t scans;
+    uint32_t delays;
+    uint32_t lost;
+    uint64_t delay_total;
+    uint32_t delay_max;
+    uint64_t cpu_ns;
+    uint64_t busy_cpu_ns;
+} stat;
+
+
+static uint64_t cpu_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static bool load_trace(const char *path)
+{
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        perror(path);
+        return false;
+    }
+
+    char line[128];
+    trace_len = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        char *comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+
+        double time;
+        unsigned row, col;
+        char state;
+        if (sscanf(line, "%lf %u %u %c", &time, &row, &col, &state) != 4 || time < 0) {
+            continue;
+        }
+        if (row >= MATRIX_ROWS || col >= MATRIX_COLS || (state != 'd' && state != 'u')) {
+            fprintf(stderr, "%s: invalid event: %s", path, line);
+            continue;
+        }
+        if (trace_len == TRACE_MAX) {
+            fprintf(stderr, "%s: too many events\n", path);
+            break;
+        }
+        trace[trace_len++] = (trace_event_t){
+            .time = (uint32_t)(time * 1000 + 0.5),
+            .row = row,
+            .col = col,
+            .pressed = (state == 'd')
+        };
+    }
+    fclose(fp);
+    return true;
+}
+
+/* report which reflects the key event, resolved with current layer state */
+static expect_t expect_for_key(uint8_t row, uint8_t col)
+{
+    action_t action = layer_switch_get_action((key_t){ .row = row, .col = col });
+    switch (action.kind.id) {
+        case ACT_LMODS:
+        case ACT_RMODS:
+            if (IS_KEY(action.key.code)) {
+                return (expect_t){ .type = EXPECT_KEY, .code = action.key.code };
+            }
+            if (IS_MOD(action.key.code)) {
+                return (expect_t){ .type = EXPECT_MODS, .code = MOD_BIT(action.key.code) };
+            }
+            if (action.key.code == KC_NO && action.key.mods) {
+                uint8_t mods = (action.kind.id == ACT_LMODS) ? action.key.mods : action.key.mods<<4;
+                return (expect_t){ .type = EXPECT_MODS, .code = mods };
+            }
+            break;
+        case ACT_LAYER:
+            return (expect_t){ .type = EXPECT_NONE };
+        case ACT_LAYER_TAP:
+        case ACT_LAYER_TAP_EXT:
+            if (action.layer_tap.code >= OP_TAP_TOGGLE) {
+                return (expect_t){ .type = EXPECT_NONE };
+            }
+            // tap key code if tapped, nothing if held
+            return (expect_t){ .type = EXPECT_TAP, .code = action.layer_tap.code };
+        default:
+            if (action.code == ACTION_NO) {
+                return (expect_t){ .type = EXPECT_NONE };
+            }
+            break;
+    }
+    // tap keys and others: any report
+    return (expect_t){ .type = EXPECT_ANY };
+}
+
+static bool report_reflects(const char *endpoint, const uint8_t *data, expect_t expect)
+{
+    if (expect.type == EXPECT_ANY) {
+        return true;
+    }
+    if (strcmp(endpoint, "keyboard") != 0) {
+        return false;
+    }
+
+    const report_keyboard_t *report = (const report_keyboard_t *)data;
+    bool on = false;
+    if (expect.type == EXPECT_MODS) {
+        on = ((report->mods & expect.code) == expect.code);
+#ifdef NKRO_ENABLE
+    } else if (keyboard_nkro) {
+        on = ((expect.code>>3) < REPORT_BITS && (report->nkro.bits[expect.code>>3] & 1<<(expect.code&7)));
+#endif
+    } else {
+        // only slots host sees
+        for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+            if (report->keys[i] == expect.code) on = true;
+        }
+    }
+    return (on == expect.pressed);
+}
+
+void sim_report(const char *endpoint, const uint8_t *data, uint8_t len)
+{
+    uint32_t now = sim_time();
+
+    stat.reports++;
+    for (uint16_t i = 0; i < pending_len; ) {
+        if (!report_reflects(endpoint, data, pending[i].expect)) {
+            i++;
+            continue;
+        }
+        uint32_t delay = now - pending[i].time;
+        stat.delays++;
+        stat.delay_total += delay;
+        if (delay > stat.delay_max) stat.delay_max = delay;
+        key_reported[pending[i].row][pending[i].col] = pending[i].expect.pressed;
+        pending[i] = pending[--pending_len];
+    }
+
+    if (verbose) {
+        printf("%8.3f %-8s:", now / 1000.0, endpoint);
+        for (uint8_t i = 0; i < len; i++) {
+            printf(" %02X", data[i]);
+        }
+        printf("\n");
+    }
+}
+
+static void replay(void)
+{
+    uint32_t start = sim_time();
+    uint16_t next = 0;
+    uint32_t end = start + (trace_len ? trace[trace_len - 1].time : 0) + SETTLE_TIME_US;
+
+    while (sim_time() < end) {
+        uint32_t now = sim_time();
+        for (; next < trace_len && start + trace[next].time <= now; next++) {
+            trace_event_t *e = &trace[next];
+            if (verbose) {
+                printf("%8.3f event   : %u/%u %c\n", now / 1000.0, e->row, e->col, e->pressed ? 'd' : 'u');
+            }
+            expect_t expect = e->pressed ? expect_for_key(e->row, e->col) : key_expect[e->row][e->col];
+            if (e->pressed) {
+                key_expect[e->row][e->col] = expect;
+            }
+            expect.pressed = e->pressed;
+            // bounce: edge back to reported state cancels the pending one
+            bool waiting = false;
+            for (uint16_t i = 0; i < pending_len; i++) {
+                if (pending[i].row != e->row || pending[i].col != e->col) continue;
+                if (e->pressed == key_reported[e->row][e->col]) {
+                    pending[i] = pending[--pending_len];
+                } else {
+                    waiting = true;
+                }
+                break;
+            }
+            if (expect.type != EXPECT_NONE && !waiting && e->pressed != key_reported[e->row][e->col]) {
+                pending[pending_len++] = (pending_t){
+                    .time = start + e->time,
+                    .row = e->row,
+                    .col = e->col,
+                    .expect = expect
+                };
+            }
+            sim_matrix_set(e->row, e->col, e->pressed);
+            stat.events++;
+        }
+
+        uint32_t reports = stat.reports;
+        bool injected = (pending_len || (next && start + trace[next - 1].time == now));
+        uint64_t t0 = cpu_now();
+        keyboard_task();
+        uint64_t cpu = cpu_now() - t0;
+        // layer tap key released without tap: held as layer key, no report
+        for (uint16_t i = 0; i < pending_len; ) {
+            if (pending[i].expect.type != EXPECT_TAP || matrix_is_on(pending[i].row, pending[i].col)) {
+                i++;
+                continue;
+            }
+            key_reported[pending[i].row][pending[i].col] = false;
+            pending[i] = pending[--pending_len];
+        }
+        stat.cpu_ns += cpu;
+        stat.scans++;
+        // scans which processed events or sent reports
+        if (injected || stat.reports != reports) {
+            stat.busy_cpu_ns += cpu;
+        }
+
+        // keyboard_task() may have advanced the clock with delays
+        if (sim_time() < now + scan_us) {
+            sim_time_set(now + scan_us);
+        }
+    }
+    stat.lost += pending_len;
+    pending_len = 0;
+    memset(key_reported, 0, sizeof(key_reported));
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-s scan_us] [-n repeat] [-v] trace...\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned repeat = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:n:v")) != -1) {
+        switch (opt) {
+            case 's': scan_us = strtoul(optarg, NULL, 0); break;
+            case 'n': repeat = strtoul(optarg, NULL, 0); break;
+            case 'v': verbose = true; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (optind >= argc || scan_us == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    host_set_driver(&sim_driver);
+    keyboard_init();
+
+    for (int i = optind; i < argc; i++) {
+        if (!load_trace(argv[i])) return 1;
+
+        memset(&stat, 0, sizeof(stat));
+        for (unsigned n = 0; n < repeat; n++) {
+            replay();
+        }
+
+        printf("%s: scan %uus\n", argv[i], scan_us);
+        printf("  events: %u  reports: %u  scans: %u\n", stat.events, stat.reports, stat.scans);
+        printf("  cpu: %.1f ns/scan  %.1f ns/event  %.0f events/sec\n",
+                stat.scans ? (double)stat.cpu_ns / stat.scans : 0.0,
+                stat.events ? (double)stat.busy_cpu_ns / stat.events : 0.0,
+                stat.busy_cpu_ns ? stat.events * 1e9 / stat.busy_cpu_ns : 0.0);
+        printf("  event->report: avg %.3f ms  max %.3f ms  unreported: %u\n",
+                stat.delays ? (double)stat.delay_total / stat.delays / 1000.0 : 0.0,
+                stat.delay_max / 1000.0, stat.lost);
+    }
+    return 0;
+}
@@ -0,0 +1,121 @@
+/*
+ * Virtual matrix: switches are set by the simulator and show up
+ * on next matrix_scan(), through common/debounce.c when
+ * PER_KEY_DEBOUNCE_ENABLE is defined.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "timer.h"
+#include "matrix.h"
+#include "sim.h"
+#ifdef PER_KEY_DEBOUNCE_ENABLE
+#include "debounce.h"
+#endif
+
+
+static matrix_row_t matrix[MATRIX_ROWS];
+static matrix_row_t matrix_raw[MATRIX_ROWS];
+/* time(ms) when switch of the row was changed */
+static uint16_t matrix_time[MATRIX_ROWS];
+static uint16_t matrix_raw_time[MATRIX_ROWS];
+/* rows changed in the last scan */
+static matrix_row_bits_t matrix_changed;
+
+
+void sim_matrix_set(uint8_t row, uint8_t col, bool on)
+{
+    if (on) {
+        matrix_raw[row] |= ((matrix_row_t)1<<col);
+    } else {
+        matrix_raw[row] &= ~((matrix_row_t)1<<col);
+    }
+    matrix_raw_time[row] = timer_read();
+}
+
+void sim_matrix_clear(void)
+{
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+        matrix_raw[i] = 0;
+    }
+}
+
+
+uint8_t matrix_rows(void)
+{
+    return MATRIX_ROWS;
+}
+
+uint8_t matrix_cols(void)
+{
+    return MATRIX_COLS;
+}
+
+void matrix_init(void)
+{
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+        matrix[i] = 0;
+        matrix_raw[i] = 0;
+    }
+#ifdef PER_KEY_DEBOUNCE_ENABLE
+    debounce_init();
+#endif
+}
+
+uint8_t matrix_scan(void)
+{
+    matrix_changed = 0;
+#ifdef PER_KEY_DEBOUNCE_ENABLE
+    debounce_tick();
+#endif
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+#ifdef PER_KEY_DEBOUNCE_ENABLE
+        matrix_row_t row = debounce_row(i, matrix_raw[i]);
+#else
+        matrix_row_t row = matrix_raw[i];
+#endif
+        if (matrix[i] != row) {
+            matrix[i] = row;
+            matrix_time[i] = matrix_raw_time[i];
+            matrix_changed |= ((matrix_row_bits_t)1<<i);
+        }
+    }
+    return 1;
+}
+
+bool matrix_is_modified(void)
+{
+    return true;
+}
+
+bool matrix_is_on(uint8_t row, uint8_t col)
+{
+    return (matrix[row] & ((matrix_row_t)1<<col));
+}
+
+matrix_row_t matrix_get_row(uint8_t row)
+{
+    return matrix[row];
+}
+
+uint16_t matrix_get_row_time(uint8_t row)
+{
+    return matrix_time[row];
+}
+
+matrix_row_bits_t matrix_changed_rows(void)
+{
+    return matrix_changed;
+}
+
+void matrix_print(void)
+{
+    printf("\nr/c 0123456789ABCDEF\n");
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        printf("%02X: ", row);
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            putchar(matrix_is_on(row, col) ? '1' : '0');
+        }
+        putchar('\n');
+    }
+}
@@ -0,0 +1,99 @@
+/*
+ * Sparse keymap generator: prints tables of keymap_sparse.h made from
+ * keymaps[] of the keymap file included as KEYMAP_C.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include KEYMAP_C
+#include "keymap_sparse.h"
+
+
+#define LAYERS  (sizeof(keymaps) / sizeof(keymaps[0]))
+
+static matrix_row_t row_bits(uint8_t layer, uint8_t row)
+{
+    matrix_row_t bits = 0;
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        if (keymaps[layer][row][col] != KC_TRNS) bits |= (matrix_row_t)1<<col;
+    }
+    return bits;
+}
+
+int main(int argc, char **argv)
+{
+    const char *name = (argc > 1 ? argv[1] : KEYMAP_C);
+    unsigned codes = 0;
+
+    for (uint8_t l = 0; l < LAYERS; l++) {
+        for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+            for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+                if (keymaps[l][r][c] != KC_TRNS) codes++;
+            }
+        }
+    }
+    unsigned full = LAYERS * MATRIX_ROWS * MATRIX_COLS;
+    unsigned sparse = LAYERS * MATRIX_ROWS * (sizeof(matrix_row_t) + sizeof(uint16_t)) + codes +
+                      MATRIX_ROWS * MATRIX_COLS * sizeof(sparse_layers_t);
+
+    printf("/*\n");
+    printf(" * Sparse keymap tables of %s, generated by sim/sim_sparse.c\n", name);
+    printf(" * %u layers, %u keycodes: %u bytes(full layers: %u bytes)\n", (unsigned)LAYERS, codes, sparse, full);
+    printf(" */\n");
+    printf("#include \"keymap_common.h\"\n");
+    printf("#include \"keymap_sparse.h\"\n\n");
+    printf("#if (SPARSE_KEYMAP_LAYERS < %u)\n", (unsigned)LAYERS);
+    printf("#error \"SPARSE_KEYMAP_LAYERS: %s has %u layers\"\n", name, (unsigned)LAYERS);
+    printf("#endif\n\n");
+
+    printf("const matrix_row_t PROGMEM sparse_keymap_rows[][MATRIX_ROWS] = {\n");
+    for (uint8_t l = 0; l < LAYERS; l++) {
+        printf("    {");
+        for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+            printf(" 0x%0*lX,", (int)sizeof(matrix_row_t) * 2, (unsigned long)row_bits(l, r));
+        }
+        printf(" },\n");
+    }
+    printf("};\n\n");
+
+    printf("const uint16_t PROGMEM sparse_keymap_index[][MATRIX_ROWS] = {\n");
+    unsigned index = 0;
+    for (uint8_t l = 0; l < LAYERS; l++) {
+        printf("    {");
+        for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+            printf(" %u,", index);
+            matrix_row_t bits = row_bits(l, r);
+            for (; bits; bits &= bits - 1) index++;
+        }
+        printf(" },\n");
+    }
+    printf("};\n\n");
+
+    printf("const uint8_t PROGMEM sparse_keymap_codes[] = {\n");
+    for (uint8_t l = 0; l < LAYERS; l++) {
+        printf("    /* layer %u */\n", l);
+        for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+            if (!row_bits(l, r)) continue;
+            printf("   ");
+            for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+                if (keymaps[l][r][c] != KC_TRNS) printf(" 0x%02X,", keymaps[l][r][c]);
+            }
+            printf("\n");
+        }
+    }
+    printf("};\n\n");
+
+    printf("const sparse_layers_t PROGMEM sparse_keymap_layers[MATRIX_ROWS][MATRIX_COLS] = {\n");
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        printf("    {");
+        for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+            unsigned long layers = 0;
+            for (uint8_t l = 0; l < LAYERS; l++) {
+                if (keymaps[l][r][c] != KC_TRNS) layers |= 1UL<<l;
+            }
+            printf(" 0x%02lX,", layers);
+        }
+        printf(" },\n");
+    }
+    printf("};\n");
+    return 0;
+}
@@ -0,0 +1,69 @@
+/*
+ * Virtual timer: time advances only when the simulator says so.
+ */
+#include <stdint.h>
+#include <util/delay.h>
+#include "timer.h"
+#include "sim.h"
+
+
+volatile uint32_t timer_count = 0;
+static uint32_t time_us = 0;
+
+
+uint32_t sim_time(void)
+{
+    return time_us;
+}
+
+void sim_time_set(uint32_t us)
+{
+    time_us = us;
+    timer_count = us / 1000;
+}
+
+void sim_delay_us(uint32_t us)
+{
+    sim_time_set(time_us + us);
+}
+
+
+void timer_init(void)
+{
+}
+
+void timer_clear(void)
+{
+    sim_time_set(0);
+}
+
+uint16_t timer_read(void)
+{
+    return (timer_count & 0xFFFF);
+}
+
+uint32_t timer_read32(void)
+{
+    return timer_count;
+}
+
+uint16_t timer_elapsed(uint16_t last)
+{
+    return TIMER_DIFF_16((timer_count & 0xFFFF), last);
+}
+
+uint32_t timer_elapsed32(uint32_t last)
+{
+    return TIMER_DIFF_32(timer_count, last);
+}
+
+uint32_t timer_read_us(void)
+{
+    return time_us;
+}
+
+uint16_t timer_read_ticks(void)
+{
+    // (TIMER_RAW_TOP+1) ticks per 1ms as Timer0 in CTC mode
+    return (time_us / 1000) * (TIMER_RAW_TOP + 1) + (time_us % 1000) * TIMER_RAW_TOP / 1000;
+}